@@ -0,0 +1,77 @@
+#pragma once
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace madlib {
+
+    /**
+     * Bump allocator for many small objects of one type. Objects are
+     * placed one after the other in fixed size chunks, reset() drops
+     * all of them at once and keeps the chunks for the next round
+     * (constant time when the type is trivially destructible).
+     */
+    template<typename T, size_t CHUNK_SIZE = 4096>
+    class Arena {
+    protected:
+        vector<T*> chunks;
+        size_t chunkIndex = 0; // current chunk
+        size_t chunkUsed = 0; // objects placed in the current chunk
+        size_t count = 0;
+
+        template<typename F>
+        void each(F f) {
+            for (size_t c = 0; c < chunks.size() && c <= chunkIndex; c++) {
+                const size_t n = c < chunkIndex ? CHUNK_SIZE : chunkUsed;
+                for (size_t i = 0; i < n; i++) f(chunks[c][i]);
+            }
+        }
+
+    public:
+
+        Arena() {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        virtual ~Arena() {
+            reset();
+            for (T* chunk: chunks) ::operator delete(chunk);
+        }
+
+        template<typename... Args>
+        T* create(Args&&... args) {
+            if (chunkUsed == CHUNK_SIZE) {
+                chunkIndex++;
+                chunkUsed = 0;
+            }
+            if (chunkIndex == chunks.size())
+                chunks.push_back(static_cast<T*>(::operator new(sizeof(T) * CHUNK_SIZE)));
+            T* elem = new (chunks[chunkIndex] + chunkUsed) T(forward<Args>(args)...);
+            chunkUsed++;
+            count++;
+            return elem;
+        }
+
+        void reset() {
+            if constexpr (!is_trivially_destructible<T>::value)
+                each([](T& elem) { elem.~T(); });
+            chunkIndex = 0;
+            chunkUsed = 0;
+            count = 0;
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        size_t capacity() const {
+            return chunks.size() * CHUNK_SIZE;
+        }
+    };
+
+}
\ No newline at end of file
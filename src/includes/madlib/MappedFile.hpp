@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../../../libs/clib/clib/err.hpp"
+
+using namespace std;
+using namespace clib;
+
+namespace madlib {
+
+    /**
+     * Read-only memory mapped view of a file as an array of T records.
+     * @note plain-old-data only
+     */
+    template<typename T>
+    class MappedFile {
+    protected:
+        void* data = nullptr;
+        size_t bytes = 0;
+        size_t count = 0;
+
+        void unmap() {
+            if (data) munmap(data, bytes);
+            data = nullptr;
+            bytes = 0;
+            count = 0;
+        }
+
+    public:
+
+        MappedFile() {}
+
+        explicit MappedFile(const string& filename) {
+            map(filename);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept:
+            data(other.data), bytes(other.bytes), count(other.count)
+        {
+            other.data = nullptr;
+            other.bytes = 0;
+            other.count = 0;
+        }
+
+        virtual ~MappedFile() {
+            unmap();
+        }
+
+        void map(const string& filename) {
+            unmap();
+            int fd = open(filename.c_str(), O_RDONLY);
+            if (fd < 0) throw ERROR("Unable to open file for mapping: " + filename);
+            struct stat st;
+            if (fstat(fd, &st) < 0) {
+                ::close(fd);
+                throw ERROR("Unable to stat file for mapping: " + filename);
+            }
+            bytes = (size_t)st.st_size;
+            count = bytes / sizeof(T);
+            if (!bytes) {
+                ::close(fd);
+                return;
+            }
+            data = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED) {
+                data = nullptr;
+                bytes = 0;
+                count = 0;
+                throw ERROR("Unable to map file: " + filename);
+            }
+            madvise(data, bytes, MADV_SEQUENTIAL);
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return !count;
+        }
+
+        const T* begin() const {
+            return (const T*)data;
+        }
+
+        const T* end() const {
+            return begin() + count;
+        }
+
+        const T& operator[](size_t at) const {
+            return begin()[at];
+        }
+    };
+
+}
\ No newline at end of file
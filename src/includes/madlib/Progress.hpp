@@ -24,10 +24,11 @@ namespace madlib {
             const string& title = "Loading...",
             bool noCancel = true,
             bool autoClose = true,
-            bool timeRemaining = true
+            bool timeRemaining = true,
+            bool headless = false // no dialog, updates always succeed
         ):  
             pipe(
-                zenity_progress(
+                headless ? nullptr : zenity_progress(
                     title, 
                     noCancel, 
                     autoClose, 
@@ -40,6 +41,7 @@ namespace madlib {
         }
 
         bool update(int percent) {
+            if (!pipe) return closed = true;
             return closed = zenity_progress_update(pipe, percent);
         }
 
@@ -52,6 +54,7 @@ namespace madlib {
                 if (*next < n) *next = n + step;
                 else return closed;
             }
+            if (!pipe) return closed = true;
             return closed = zenity_progress_update(pipe, status);
         }
 
@@ -74,6 +77,7 @@ namespace madlib {
 
         int close() {
             closed = true;
+            if (!pipe) return 0;
             return zenity_progress_close(pipe);
         }
     };
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+namespace madlib {
+
+    /**
+     * Minimum of lows and maximum of highs over any index range.
+     * Elements are grouped in blocks of BLOCK_SIZE, a sparse table over
+     * the complete blocks answers the block aligned middle of a range
+     * with two lookups, only the partial blocks at the edges are scanned.
+     * Memory stays close to the elements themselves (the table holds
+     * n / BLOCK_SIZE * log(n) entries).
+     */
+    template<size_t BLOCK_SIZE = 32>
+    class RangeMinMax {
+    protected:
+        vector<double> lows;
+        vector<double> highs;
+        // levels[k][j]: extremes of the blocks [j, j + 2^k)
+        vector<vector<double>> levelLows;
+        vector<vector<double>> levelHighs;
+
+        static size_t floorLog2(size_t n) {
+            size_t k = 0;
+            while (n >>= 1) k++;
+            return k;
+        }
+
+        void scan(size_t from, size_t to, double& min, double& max) const {
+            for (size_t i = from; i < to; i++) {
+                if (min > lows[i]) min = lows[i];
+                if (max < highs[i]) max = highs[i];
+            }
+        }
+
+        // a block just completed, extends every level with the entry ending at it
+        void indexLastBlock() {
+            const size_t block = lows.size() / BLOCK_SIZE - 1;
+            double min = lows[block * BLOCK_SIZE], max = highs[block * BLOCK_SIZE];
+            scan(block * BLOCK_SIZE + 1, (block + 1) * BLOCK_SIZE, min, max);
+            if (levelLows.empty()) {
+                levelLows.emplace_back();
+                levelHighs.emplace_back();
+            }
+            levelLows[0].push_back(min);
+            levelHighs[0].push_back(max);
+            for (size_t k = 1; ((size_t)1 << k) <= block + 1; k++) {
+                if (levelLows.size() == k) {
+                    levelLows.emplace_back();
+                    levelHighs.emplace_back();
+                }
+                const size_t j = block + 1 - ((size_t)1 << k);
+                const size_t half = (size_t)1 << (k - 1);
+                const double low1 = levelLows[k - 1][j], low2 = levelLows[k - 1][j + half];
+                const double high1 = levelHighs[k - 1][j], high2 = levelHighs[k - 1][j + half];
+                levelLows[k].push_back(low1 < low2 ? low1 : low2);
+                levelHighs[k].push_back(high1 > high2 ? high1 : high2);
+            }
+        }
+
+    public:
+
+        RangeMinMax() {}
+
+        virtual ~RangeMinMax() {}
+
+        void clear() {
+            lows.clear();
+            highs.clear();
+            levelLows.clear();
+            levelHighs.clear();
+        }
+
+        void reserve(size_t size) {
+            lows.reserve(size);
+            highs.reserve(size);
+        }
+
+        size_t size() const {
+            return lows.size();
+        }
+
+        void push_back(double low, double high) {
+            lows.push_back(low);
+            highs.push_back(high);
+            if (lows.size() % BLOCK_SIZE == 0) indexLastBlock();
+        }
+
+        // rebuilds the index over the accessors lowAt(i), highAt(i)
+        template<typename Low, typename High>
+        void build(size_t size, Low lowAt, High highAt) {
+            clear();
+            reserve(size);
+            for (size_t i = 0; i < size; i++) push_back(lowAt(i), highAt(i));
+        }
+
+        // extremes over [from, to), false when the range is empty
+        bool query(size_t from, size_t to, double& min, double& max) const {
+            if (to > lows.size()) to = lows.size();
+            if (from >= to) return false;
+            min = lows[from];
+            max = highs[from];
+            const size_t indexed = levelLows.empty() ? 0 : levelLows[0].size();
+            const size_t firstBlock = (from + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            size_t lastBlock = to / BLOCK_SIZE;
+            if (lastBlock > indexed) lastBlock = indexed;
+            if (firstBlock >= lastBlock) {
+                scan(from + 1, to, min, max);
+                return true;
+            }
+            scan(from + 1, firstBlock * BLOCK_SIZE, min, max);
+            scan(lastBlock * BLOCK_SIZE, to, min, max);
+            const size_t k = floorLog2(lastBlock - firstBlock);
+            const size_t second = lastBlock - ((size_t)1 << k);
+            const vector<double>& levelLow = levelLows[k];
+            const vector<double>& levelHigh = levelHighs[k];
+            if (min > levelLow[firstBlock]) min = levelLow[firstBlock];
+            if (min > levelLow[second]) min = levelLow[second];
+            if (max < levelHigh[firstBlock]) max = levelHigh[firstBlock];
+            if (max < levelHigh[second]) max = levelHigh[second];
+            return true;
+        }
+    };
+
+}
\ No newline at end of file
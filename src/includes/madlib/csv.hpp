@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+namespace madlib {
+
+    /**
+     * A CSV field as a view into the parsed buffer (no allocation).
+     */
+    struct CsvField {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        bool empty() const {
+            return begin == end;
+        }
+
+        size_t size() const {
+            return (size_t)(end - begin);
+        }
+
+        CsvField trim() const {
+            CsvField field = *this;
+            while (field.begin < field.end && isspace((unsigned char)*field.begin)) field.begin++;
+            while (field.end > field.begin && isspace((unsigned char)field.end[-1])) field.end--;
+            return field;
+        }
+
+        string str() const {
+            return string(begin, end);
+        }
+    };
+
+    // returns the end of the line (position of '\n' or the buffer end)
+    inline const char* csv_line_end(const char* p, const char* end) {
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+        return nl ? nl : end;
+    }
+
+    // skips to the beginning of the next line
+    inline const char* csv_next_line(const char* p, const char* end) {
+        p = csv_line_end(p, end);
+        return p < end ? p + 1 : end;
+    }
+
+    // reads the next field of a line and moves p after the separator
+    inline CsvField csv_next_field(const char*& p, const char* lineEnd, char separator = ',') {
+        CsvField field;
+        field.begin = p;
+        const char* sep = (const char*)memchr(p, separator, (size_t)(lineEnd - p));
+        field.end = sep ? sep : lineEnd;
+        p = sep ? sep + 1 : lineEnd;
+        return field;
+    }
+
+    // splits a line into fields, returns the number of fields found (up to max)
+    inline size_t csv_split_line(const char* p, const char* lineEnd, CsvField* fields, size_t max, char separator = ',') {
+        size_t count = 0;
+        while (count < max) {
+            fields[count++] = csv_next_field(p, lineEnd, separator);
+            if (p >= lineEnd) break;
+        }
+        return count;
+    }
+
+    template<typename T>
+    bool csv_parse(const CsvField& field, T& value) {
+        CsvField trimmed = field.trim();
+        if (trimmed.empty()) return false;
+        const char* begin = trimmed.begin;
+        if (*begin == '+') begin++;
+        from_chars_result result = from_chars(begin, trimmed.end, value);
+        return result.ec == errc() && result.ptr == trimmed.end;
+    }
+
+    /**
+     * Splits a buffer into (at most) the given number of chunks,
+     * every chunk boundary is moved to a line beginning.
+     */
+    inline vector<CsvField> csv_split_chunks(const char* begin, const char* end, size_t chunks) {
+        vector<CsvField> result;
+        if (!chunks) chunks = 1;
+        const size_t size = (size_t)(end - begin);
+        const char* chunkBegin = begin;
+        for (size_t i = 1; i <= chunks && chunkBegin < end; i++) {
+            const char* chunkEnd = i == chunks ? end : begin + (size * i) / chunks;
+            if (chunkEnd < chunkBegin) chunkEnd = chunkBegin;
+            chunkEnd = csv_next_line(chunkEnd, end);
+            result.push_back({ chunkBegin, chunkEnd });
+            chunkBegin = chunkEnd;
+        }
+        return result;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../../../libs/clib/clib/time.hpp"
+
+using namespace std;
+using namespace clib;
+
+namespace madlib {
+
+    // days since 1970-01-01 of a proleptic gregorian date (H. Hinnant's algorithm)
+    inline int64_t days_from_civil(int64_t year, unsigned month, unsigned day) {
+        year -= month <= 2;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const unsigned yoe = (unsigned)(year - era * 400);
+        const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + (int64_t)doe - 719468;
+    }
+
+    inline unsigned days_in_month(int year, unsigned month) {
+        static const unsigned char days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) return 29;
+        return days[month - 1];
+    }
+
+    /**
+     * Cached days-from-civil of the first day of every month
+     * for the years [first, first + years).
+     */
+    class CivilMonthTable {
+    public:
+        static const int first = 1970;
+        static const int years = 200;
+
+    protected:
+        int32_t days[years * 12];
+
+    public:
+        CivilMonthTable() {
+            for (int y = 0; y < years; y++)
+                for (unsigned m = 0; m < 12; m++)
+                    days[y * 12 + m] = (int32_t)days_from_civil(first + y, m + 1, 1);
+        }
+
+        static const CivilMonthTable& instance() {
+            static const CivilMonthTable table;
+            return table;
+        }
+
+        int64_t get(int year, unsigned month, unsigned day) const {
+            const unsigned at = (unsigned)(year - first) * 12 + month - 1;
+            if (at >= (unsigned)years * 12 || month - 1 >= 12)
+                return days_from_civil(year, month, day);
+            return days[at] + (int64_t)day - 1;
+        }
+    };
+
+    /**
+     * Decodes exactly 19 characters of "YYYY-MM-DD HH:MM:SS" (UTC).
+     * Digits are decoded without branching, invalid input is
+     * detected once at the end.
+     * @return false if the text does not match the layout
+     */
+    inline bool datetime_fixed_to_ms(const char* p, ms_t& ms) {
+        unsigned d[14];
+        static const unsigned char at[14] = { 0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18 };
+        unsigned bad = 0;
+        for (int i = 0; i < 14; i++) {
+            d[i] = (unsigned)(unsigned char)p[at[i]] - '0';
+            bad |= d[i] > 9;
+        }
+        bad |= (p[4] != '-') | (p[7] != '-') | (p[10] != ' ' && p[10] != 'T') | (p[13] != ':') | (p[16] != ':');
+        const int year = (int)(d[0] * 1000 + d[1] * 100 + d[2] * 10 + d[3]);
+        const unsigned month = d[4] * 10 + d[5];
+        const unsigned day = d[6] * 10 + d[7];
+        const unsigned hours = d[8] * 10 + d[9];
+        const unsigned minutes = d[10] * 10 + d[11];
+        const unsigned seconds = d[12] * 10 + d[13];
+        bad |= (month - 1 >= 12) | (day - 1 >= 31) | (hours >= 24) | (minutes >= 60) | (seconds >= 61);
+        if (bad || day > days_in_month(year, month)) return false;
+        const int64_t days = CivilMonthTable::instance().get(year, month, day);
+        ms = (ms_t)(((days * 24 + hours) * 60 + minutes) * 60 + seconds) * MS_PER_SEC;
+        return true;
+    }
+
+    /**
+     * Fixed layout when possible, falls back to the general parser
+     * (e.g. for a date only or a fraction of seconds)
+     */
+    inline ms_t datetime_fast_to_ms(const char* begin, const char* end) {
+        ms_t ms;
+        if (end - begin == 19 && datetime_fixed_to_ms(begin, ms)) return ms;
+        return datetime_to_ms(string(begin, end));
+    }
+
+    // UNIX timestamp field in seconds or (if large enough) in milliseconds
+    inline ms_t unix_to_ms(double unixTime) {
+        return unixTime > 1e11 ? (ms_t)unixTime : (ms_t)(unixTime * MS_PER_SEC);
+    }
+
+}
\ No newline at end of file
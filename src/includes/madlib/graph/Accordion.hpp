@@ -159,6 +159,13 @@ namespace madlib::graph {
         vector<Container*> containers;
         bool single;
 
+        // the accordion changed its height, the parent repaints the place it had
+        void redrawParent() {
+            Area* area = getParentOrSelf();
+            area->invalidate();
+            area->draw();
+        }
+
     public:
         Accordion(
             GFX* gfx, int left, int top, int width,
@@ -204,7 +211,7 @@ namespace madlib::graph {
                     }
                 }
             }
-            if (redraw) getParentOrSelf()->draw();
+            if (redraw) redrawParent();
         }
 
         void closeAllExcept(size_t exceptIndex, bool redraw) {
@@ -213,7 +220,7 @@ namespace madlib::graph {
                 if (i != exceptIndex) closeAt(i, false);
                 else openAt(i, false);
             }
-            if (redraw) getParentOrSelf()->draw();
+            if (redraw) redrawParent();
         }
 
         void closeAllExcept(const vector<size_t>& exceptIndexes, bool redraw) {
@@ -222,7 +229,7 @@ namespace madlib::graph {
                 if (!vector_contains(exceptIndexes, i)) closeAt(i, false);
                 else openAt(i, false);
             }
-            if (redraw) getParentOrSelf()->draw();
+            if (redraw) redrawParent();
         }
 
         vector<size_t> closeAll(bool redraw) {
@@ -232,7 +239,7 @@ namespace madlib::graph {
                 if (containers[i]->isOpened()) wasOpens.push_back(i);
                 closeAt(i, false);
             }
-            if (redraw) getParentOrSelf()->draw();
+            if (redraw) redrawParent();
             return wasOpens;
         }
 
@@ -241,7 +248,7 @@ namespace madlib::graph {
             for (size_t i = 0; i < containersSize; i++) {
                 openAt(i, false);
             }
-            if (redraw) getParentOrSelf()->draw();
+            if (redraw) redrawParent();
         }
 
         Container* createContainer(const string& title, int frameHeight) {
@@ -272,7 +279,7 @@ namespace madlib::graph {
             height += frameHeight;
             Area* parent = getParent();
             if (parent) parent->adaptScrollSize(this);
-            if (redraw) getParentOrSelf()->draw();
+            if (redraw) redrawParent();
         }
 
         void closeAt(size_t containerIndex, bool redraw) {
@@ -292,7 +299,7 @@ namespace madlib::graph {
             height -= frameHeight;
             Area* parent = getParent();
             if (parent) parent->adaptScrollSize(this);
-            if (redraw) getParentOrSelf()->draw();
+            if (redraw) redrawParent();
         }
 
         // void toggleAt(size_t containerIndex) {
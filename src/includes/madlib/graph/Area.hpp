@@ -40,6 +40,7 @@ namespace madlib::graph {
                     that->dragScrollStartedX + (that->dragStartedX - x), 
                     that->dragScrollStartedY + (that->dragStartedY - y)
                 );
+                that->invalidate();
                 that->draw();
             }
         }
@@ -60,14 +61,42 @@ namespace madlib::graph {
         vector<Area*> areas;
         Area* parent = nullptr;
 
-        void reduceViewport(Viewport& viewport) const {
-            if (!parent) return;
+        bool dirty = true; // changed since the last draw
+        bool exposed = true; // painted over (e.g. by the parent) since the last draw
+
+        // (of the root) the visible rects invalidated since they were drawn, in window coordinates
+        vector<Viewport> damage;
+
+        void addDamage(const Viewport& rect) {
+            for (const Viewport& damaged: damage)
+                if (rect.insideOf(damaged)) return;
+            damage.push_back(rect);
+        }
+
+        // the rects inside a drawn area are repainted
+        void clearDamage(const Viewport& rect) {
+            damage.erase(remove_if(damage.begin(), damage.end(), [&rect](const Viewport& damaged) {
+                return damaged.insideOf(rect);
+            }), damage.end());
+        }
+
+        // damage reaching into the rect from outside (e.g. an overlapping sibling was redrawn)
+        bool isDamagedFromOutside(const Viewport& rect) const {
+            for (const Viewport& damaged: damage)
+                if (damaged.containsPartially(rect) && !damaged.insideOf(rect)) return true;
+            return false;
+        }
+
+        // false when nothing remains visible
+        bool reduceViewport(Viewport& viewport) const {
+            if (!parent) return true;
             int parentTop = parent->getTop() + 1;
             int parentLeft = parent->getLeft() + 1;
             int parentRight = parent->getRight(parentLeft) - 2;
             int parentBottom = parent->getBottom(parentTop) - 2;
             if (viewport.intersect(parentLeft, parentTop, parentRight, parentBottom))
-                parent->reduceViewport(viewport);
+                return parent->reduceViewport(viewport);
+            return false;
         }
 
         void prepareSetViewport() const {
@@ -174,6 +203,27 @@ namespace madlib::graph {
             gfx->drawLine(x1, y1, x2, y2);
         }
 
+        // the points are translated in place to window coordinates
+        virtual void polyline(vector<Pixel>& points) override {
+            if (points.empty()) return;
+            Viewport bounds(points[0].x, points[0].y, points[0].x, points[0].y);
+            for (const Pixel& point: points) {
+                if (point.x < bounds.x1) bounds.x1 = point.x;
+                if (point.y < bounds.y1) bounds.y1 = point.y;
+                if (point.x > bounds.x2) bounds.x2 = point.x;
+                if (point.y > bounds.y2) bounds.y2 = point.y;
+            }
+            setScrollXY12MinMax(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+            const int leftAndScroll = getLeft() - scrollX; // TODO: calculate zoom too
+            const int topAndScroll = getTop() - scrollY;
+            for (Pixel& point: points) {
+                point.x += leftAndScroll;
+                point.y += topAndScroll;
+            }
+            prepareSetViewport();
+            gfx->drawPolyline(points);
+        }
+
         virtual void hLine(int x1, int y1, int x2) override {
             int y2 = y1;
             setScrollXY12MinMax(x1, y1, x2, y2);
@@ -208,6 +258,28 @@ namespace madlib::graph {
             return gfx;
         }
 
+        bool isDirty() const {
+            return dirty;
+        }
+
+        // the next draw has to render again (cached content is dropped)
+        virtual void invalidate() {
+            if (dirty) return;
+            dirty = true;
+            Viewport visible;
+            getViewport(visible);
+            if (reduceViewport(visible)) getRoot()->addDamage(visible);
+        }
+
+        // the pixels are lost (e.g. a window expose), the next draw repaints without rendering again
+        void expose() {
+            exposed = true;
+        }
+
+        const vector<Viewport>& getDamage() {
+            return getRoot()->damage;
+        }
+
         void setParent(Area* parent) {
             this->parent = parent;
         }
@@ -228,6 +300,7 @@ namespace madlib::graph {
             adaptScrollSize(area);
             area->setParent(this);
             areas.push_back(area);
+            invalidate();
             return area;
         }
 
@@ -236,6 +309,7 @@ namespace madlib::graph {
                 return a == area;
             });
             areas.erase(it, areas.end());
+            invalidate();
         }
 
         void adaptScrollSize(Area* area) {
@@ -250,8 +324,11 @@ namespace madlib::graph {
             return top + (parent ? parent->getTop() - parent->scrollY : 0);
         }
 
+        // moving an area damages its old place in the parent
         void setTop(int top) {
+            if (this->top == top) return;
             this->top = top;
+            getParentOrSelf()->invalidate();
         }
 
         int getLeft(bool withParent = true) const {
@@ -260,7 +337,9 @@ namespace madlib::graph {
         }
 
         void setLeft(int left) {
+            if (this->left == left) return;
             this->left = left;
+            getParentOrSelf()->invalidate();
         }
 
         int getRight(bool withParent = true) const {
@@ -293,6 +372,7 @@ namespace madlib::graph {
 
         void setBorder(Border border) {
             this->border = border;
+            invalidate();
         }
 
         string getText() const {
@@ -301,6 +381,7 @@ namespace madlib::graph {
 
         void setText(const string& text) {
             this->text = text;
+            invalidate();
         }
 
         Align getTextAlign() const {
@@ -313,6 +394,7 @@ namespace madlib::graph {
 
         void setBackgroundColor(Color backgroundColor) {
             this->backgroundColor = backgroundColor;
+            invalidate();
         }
 
         Color getBorderColor() const {
@@ -321,6 +403,7 @@ namespace madlib::graph {
 
         void setBorderColor(Color borderColor) {
             this->borderColor = borderColor;
+            invalidate();
         }
 
         Color getTextColor() const {
@@ -329,6 +412,7 @@ namespace madlib::graph {
 
         void setTextColor(Color textColor) {
             this->textColor = textColor;
+            invalidate();
         }
 
         bool contains(int x, int y) const {
@@ -439,7 +523,26 @@ namespace madlib::graph {
             drawBorder(l, t, r, b);
         }
 
+        /**
+         * Repaints the area and its children when it was invalidated or
+         * painted over, otherwise only the children are visited and the
+         * clean subtrees are skipped (the invalidated descendants repaint
+         * themselves, the ones overlapped by damage from outside too).
+         */
         virtual void draw() override {
+            if (!dirty && !exposed) {
+                Area* root = getRoot();
+                for (Area* area: areas) {
+                    if (!contains(area)) continue;
+                    Viewport visible;
+                    area->getViewport(visible);
+                    if (area->reduceViewport(visible) && root->isDamagedFromOutside(visible)) area->expose();
+                    area->draw();
+                }
+                if (!parent) damage.clear();
+                return;
+            }
+
             int t = getTop();
             int l = getLeft();
             int w = width;
@@ -485,12 +588,29 @@ namespace madlib::graph {
             }
 
             for (Area* area: areas)
-                if (contains(area)) area->draw();
+                if (contains(area)) {
+                    area->expose();
+                    area->draw();
+                }
 
             for (const onDrawHandler& onDraw: onDrawHandlers) {
                 onDraw(this);
             }
 
+            drawn();
+        }
+
+        // the area is on the screen as it is now
+        void drawn() {
+            dirty = false;
+            exposed = false;
+            if (!parent) {
+                damage.clear();
+                return;
+            }
+            Viewport visible;
+            getViewport(visible);
+            if (reduceViewport(visible)) getRoot()->clearDamage(visible);
         }
     };
 
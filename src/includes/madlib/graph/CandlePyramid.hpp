@@ -0,0 +1,150 @@
+#pragma once
+
+#include "CandleShape.hpp"
+
+namespace madlib::graph {
+
+    /**
+     * Precomputed OHLC levels over a candle series,
+     * level k aggregates 2^k neighbour candles (level 0 is the series itself).
+     * The last candle of a live series keeps changing, update() rebuilds
+     * when the count changes and only refreshes the last entry of every
+     * level when just the last candle did.
+     */
+    class CandlePyramid {
+    public:
+
+        struct Entry {
+            ms_t begin;
+            ms_t end;
+            double open;
+            double low;
+            double high;
+            double close;
+        };
+
+        static Entry entry(const CandleShape& candle) {
+            return {
+                candle.begin(), candle.end(),
+                candle.open(), candle.low(), candle.high(), candle.close()
+            };
+        }
+
+        // the candles are either shapes or value-typed
+        static const CandleShape& candleAt(const vector<Shape*>& shapes, size_t i) {
+            return *(const CandleShape*)shapes[i];
+        }
+
+        static const CandleShape& candleAt(const vector<CandleShape>& candles, size_t i) {
+            return candles[i];
+        }
+
+        static bool equals(const Entry& a, const Entry& b) {
+            return
+                a.begin == b.begin && a.end == b.end &&
+                a.open == b.open && a.low == b.low &&
+                a.high == b.high && a.close == b.close;
+        }
+
+        static Entry merge(const Entry& first, const Entry& second) {
+            return {
+                first.begin, second.end,
+                first.open,
+                first.low < second.low ? first.low : second.low,
+                first.high > second.high ? first.high : second.high,
+                second.close
+            };
+        }
+
+        // aggregates the candles [from, to) directly
+        template<typename Candles>
+        static Entry aggregate(const Candles& candles, size_t from, size_t to) {
+            Entry result = entry(candleAt(candles, from));
+            for (size_t i = from + 1; i < to; i++)
+                result = merge(result, entry(candleAt(candles, i)));
+            return result;
+        }
+
+    protected:
+
+        vector<vector<Entry>> levels; // levels[k - 1] holds level k
+        size_t count = 0;
+        Entry last = {}; // the last candle at the time it was aggregated
+
+        // recalculates the entries that cover the last candle
+        template<typename Candles>
+        void updateLast(const Candles& candles) {
+            if (levels.empty()) return;
+            size_t i = (count - 1) / 2;
+            levels[0][i] = aggregate(candles, i * 2, i * 2 + 2 < count ? i * 2 + 2 : count);
+            for (size_t level = 1; level < levels.size(); level++) {
+                const vector<Entry>& prev = levels[level - 1];
+                i = (prev.size() - 1) / 2;
+                levels[level][i] = i * 2 + 1 < prev.size() ? merge(prev[i * 2], prev[i * 2 + 1]) : prev[i * 2];
+            }
+        }
+
+    public:
+
+        template<typename Candles>
+        void build(const Candles& candles) {
+            clear();
+            count = candles.size();
+            if (count) last = entry(candleAt(candles, count - 1));
+            if (count < 2) return;
+            levels.emplace_back();
+            vector<Entry>& first = levels.back();
+            first.reserve((count + 1) / 2);
+            for (size_t i = 0; i < count; i += 2)
+                first.push_back(aggregate(candles, i, i + 2 < count ? i + 2 : count));
+            while (levels.back().size() > 1) {
+                const vector<Entry>& prev = levels.back();
+                vector<Entry> next;
+                next.reserve((prev.size() + 1) / 2);
+                for (size_t i = 0; i < prev.size(); i += 2)
+                    next.push_back(i + 1 < prev.size() ? merge(prev[i], prev[i + 1]) : prev[i]);
+                levels.push_back(move(next));
+            }
+        }
+
+        template<typename Candles>
+        void update(const Candles& candles) {
+            if (candles.size() != count) {
+                build(candles);
+                return;
+            }
+            if (!count) return;
+            const Entry current = entry(candleAt(candles, count - 1));
+            if (equals(current, last)) return;
+            last = current;
+            updateLast(candles);
+        }
+
+        void clear() {
+            levels.clear();
+            count = 0;
+        }
+
+        // number of the candles the pyramid is built over
+        size_t getCount() const {
+            return count;
+        }
+
+        // highest level available (0 means only the series itself)
+        size_t getLevels() const {
+            return levels.size();
+        }
+
+        const vector<Entry>& getLevel(size_t level) const {
+            return levels.at(level - 1);
+        }
+
+        // the level where one entry still covers at most the given candles
+        size_t selectLevel(size_t candlesPerPixel) const {
+            size_t level = 0;
+            while (level < levels.size() && ((size_t)2 << level) <= candlesPerPixel) level++;
+            return level;
+        }
+    };
+
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CandleShape.hpp"
+#include "CandlePyramid.hpp"
 
 namespace madlib::graph {
     
@@ -10,74 +11,101 @@ namespace madlib::graph {
         const Color colorUp;
         const Color colorDown;
 
-        void projectFirstLastValue() {
+        CandlePyramid pyramid;
+        size_t pyramidShapesEdits = 0; // shapesEdits when the pyramid was last refreshed
+
+        // value-typed candles (see addCandle()), projected instead of the shapes when not empty
+        vector<CandleShape> candles;
+        RangeMinMax<> candlesValueIndex; // extended with the candles added since the last search
+
+        void projectEnvelope(const CandlePyramid::Entry& entry) {
+            timeRangeArea->brush(entry.open > entry.close ? colorDown : colorUp);
+            timeRangeArea->vLine(
+                translateX(entry.begin + (entry.end - entry.begin) / 2),
+                canvas.chartHeight - translateY(entry.high),
+                canvas.chartHeight - translateY(entry.low)
+            );
+        }
+
+        // one OHLC envelope per pyramid entry, partial entries at the edges are aggregated from the candles
+        template<typename Candles>
+        void projectLevel(const Candles& source, size_t level) {
+            const size_t size = (size_t)1 << level;
+            const vector<CandlePyramid::Entry>& entries = pyramid.getLevel(level);
+            const size_t from = canvas.shapeIndexFrom;
+            const size_t to = canvas.shapeIndexTo;
+            const size_t first = (from + size - 1) / size;
+            const size_t last = to / size;
+            if (first >= last) {
+                projectEnvelope(CandlePyramid::aggregate(source, from, to));
+                return;
+            }
+            if (from < first * size) projectEnvelope(CandlePyramid::aggregate(source, from, first * size));
+            for (size_t i = first; i < last; i++) projectEnvelope(entries[i]);
+            if (last * size < to) projectEnvelope(CandlePyramid::aggregate(source, last * size, to));
+        }
+
+        template<typename Candles>
+        void projectFirstLastValue(const Candles& source) {
             string text;
 
-            const CandleShape* first = (const CandleShape*)shapes[canvas.shapeIndexFrom];
+            const CandleShape& first = CandlePyramid::candleAt(source, canvas.shapeIndexFrom);
             timeRangeArea->brush(
-                first->open() > first->close() ? colorDown : colorUp
+                first.open() > first.close() ? colorDown : colorUp
             );
-            text = to_string(first->open());
+            text = to_string(first.open());
             TextSize textSize = timeRangeArea->getTextSize(text);
             timeRangeArea->write(
                 -textSize.width, 
-                canvas.chartHeight - translateY(first->open()), 
+                canvas.chartHeight - translateY(first.open()), 
                 text
             );
 
-            const CandleShape* last = (const CandleShape*)shapes[canvas.shapeIndexTo];
+            const CandleShape& last = CandlePyramid::candleAt(source, canvas.shapeIndexTo);
             timeRangeArea->brush(
-                last->open() > last->close() ? colorDown : colorUp
+                last.open() > last.close() ? colorDown : colorUp
             );
-            text = to_string(last->close());
+            text = to_string(last.close());
             timeRangeArea->write(
                 canvas.chartWidth,
-                canvas.chartHeight - translateY(last->close()), 
+                canvas.chartHeight - translateY(last.close()), 
                 text
             );
         }
 
-    public:
-
-        explicit CandleSeries(
-            TimeRangeArea* timeRangeArea,
-            const Color colorUp = Theme::defaultChartCandleColorUp,
-            const Color colorDown = Theme::defaultChartCandleColorDown
-        ):
-            Projector(timeRangeArea),
-            colorUp(colorUp),
-            colorDown(colorDown)
-        {}
-
-        virtual ~CandleSeries() {}
+        // the pyramid only follows appends and the last candle, it is
+        // rebuilt after a mutable getShapes() that may have edited any candle
+        template<typename Candles>
+        void updatePyramid(const Candles& source) {
+            if (pyramidShapesEdits != shapesEdits) {
+                pyramid.clear();
+                pyramidShapesEdits = shapesEdits;
+            }
+            pyramid.update(source);
+        }
 
-        virtual void project() override {
-            size_t step = (canvas.shapeIndexTo - canvas.shapeIndexFrom) / (size_t)canvas.chartWidth;
-            double prevClose = 0;
-            if (step < 1) step = 1;
-            for (size_t i = canvas.shapeIndexFrom; i < canvas.shapeIndexTo; i += step) {
-                const CandleShape* candle = (const CandleShape*)shapes[i];
-
-                if (step > 1) { 
-                    double candleClose = candle->close();
-                    if (!prevClose) prevClose = candleClose;
-                    Color color = prevClose > candleClose ? colorDown : colorUp;
-                    timeRangeArea->brush(color);
-                    int x = translateX(candle->end());
-                    int y1 = canvas.chartHeight - translateY(prevClose);
-                    int y2 = canvas.chartHeight - translateY(candleClose);
-                    timeRangeArea->vLine(x, y1, y2);
-                    prevClose = candleClose;
-                    continue;
+        template<typename Candles>
+        void projectCandles(const Candles& source) {
+            const size_t step = (canvas.shapeIndexTo - canvas.shapeIndexFrom) / (size_t)canvas.chartWidth;
+            if (step > 1) {
+                updatePyramid(source);
+                const size_t level = pyramid.selectLevel(step);
+                if (level) {
+                    projectLevel(source, level);
+                    projectFirstLastValue(source);
+                    return;
                 }
+            }
+            for (size_t i = canvas.shapeIndexFrom; i < canvas.shapeIndexTo; i++) {
+                const CandleShape& candle = CandlePyramid::candleAt(source, i);
 
-                Color color = candle->open() > candle->close() ? colorDown : colorUp;
+                Color color = candle.open() > candle.close() ? colorDown : colorUp;
                 timeRangeArea->brush(color);
 
-                const ms_t mid = candle->begin() + (candle->end() - candle->begin()) / 2;
+                const ms_t mid = candle.begin() + (candle.end() - candle.begin()) / 2;
                 int wick = translateX(mid);
-                int high = translateY(candle->high());
-                int low = translateY(candle->low());
+                int high = translateY(candle.high());
+                int low = translateY(candle.low());
 
                 timeRangeArea->vLine(
                     wick, 
@@ -85,22 +113,85 @@ namespace madlib::graph {
                     canvas.chartHeight - low
                 );
                 
-                int left = translateX(candle->begin());
-                int right = translateX(candle->end());
+                int left = translateX(candle.begin());
+                int right = translateX(candle.end());
                 int diff = right - left;
                 if (diff > 3) {
                     left += 1;
                     right -= 1;
                 }
-                int open = translateY(candle->open());
-                int close = translateY(candle->close());
+                int open = translateY(candle.open());
+                int close = translateY(candle.close());
                 timeRangeArea->fRect(
                     left, canvas.chartHeight - open, 
                     right, canvas.chartHeight - close
                 );
             }
 
-            projectFirstLastValue();
+            projectFirstLastValue(source);
+        }
+
+    public:
+
+        explicit CandleSeries(
+            TimeRangeArea* timeRangeArea,
+            const Color colorUp = Theme::defaultChartCandleColorUp,
+            const Color colorDown = Theme::defaultChartCandleColorDown
+        ):
+            Projector(timeRangeArea),
+            colorUp(colorUp),
+            colorDown(colorDown)
+        {}
+
+        virtual ~CandleSeries() {}
+
+        const vector<CandleShape>& getCandles() const {
+            return candles;
+        }
+
+        virtual size_t size() const override {
+            return candles.empty() ? shapes.size() : candles.size();
+        }
+
+        void reserveCandles(size_t size) {
+            candles.reserve(size);
+        }
+
+        void addCandle(
+            ms_t begin,
+            ms_t end,
+            double open,
+            double low,
+            double high,
+            double close
+        ) {
+            candles.emplace_back(begin, end, open, low, high, close);
+            version++;
+        }
+
+        virtual bool searchShapeIndexFromToAndValueMinMax() override {
+            if (candles.empty()) return Projector::searchShapeIndexFromToAndValueMinMax();
+            const CandleShape* data = candles.data();
+            for (size_t i = candlesValueIndex.size(); i < candles.size(); i++)
+                candlesValueIndex.push_back(data[i].low(), data[i].high());
+            if (!searchIndexFromTo(
+                candles.size(),
+                [data](size_t i) { return data[i].begin(); },
+                [data](size_t i) { return data[i].end(); }
+            )) return false;
+            return stretchToValueMinMax(candlesValueIndex);
+        }
+
+        virtual void project() override {
+            if (candles.empty()) projectCandles(shapes);
+            else projectCandles(candles);
+        }
+
+        virtual void clearShapes() override {
+            Projector::clearShapes();
+            candles.clear();
+            candlesValueIndex.clear();
+            pyramid.clear();
         }
     };
 
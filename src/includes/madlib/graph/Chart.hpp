@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../vectors.hpp"
+#include "../Arena.hpp"
 
 #include "TimeRangeArea.hpp"
 #include "Projector.hpp"
@@ -134,9 +135,80 @@ namespace madlib::graph {
         vector<CandleSeries*> candleSeriesProjectors;
         vector<LabelSeries*> labelSeriesProjectors;
 
-        vector<PointShape*> pointShapes;
-        vector<CandleShape*> candleShapes;
-        vector<LabelShape*> labelShapes;
+        // offscreen copy of the last rendering, blitted again while
+        // nothing it was rendered from changes (see draw())
+        struct DrawCache {
+            Pixmap pixmap = 0;
+            int width = 0, height = 0;
+            Viewport area;
+            Viewport visible;
+            ms_t begin = 0, end = 0;
+            size_t content = 0; // see getContentVersion()
+        } drawCache;
+
+        static bool sameViewport(const Viewport& a, const Viewport& b) {
+            return a.x1 == b.x1 && a.y1 == b.y1 && a.x2 == b.x2 && a.y2 == b.y2;
+        }
+
+        // the projector versions only grow, so the sum changes with any of them
+        size_t getContentVersion() const {
+            size_t version = 0;
+            for (const Projector* projector: projectors) version += projector->getVersion();
+            return version;
+        }
+
+        void drawContent() {
+            TimeRangeArea::draw();
+
+            // for (const Alignment& alignment: alignments) {
+            //     LOG("Aligning: " + to_string((unsigned long long)alignment.getProjector()) + " to: " + to_string((unsigned long long)alignment.getAlignToProjector()));
+            //     alignment.getProjector()->align(
+            //         alignment.getAlignToProjector(), 
+            //         alignment.isExtends()
+            //     );
+            // }
+
+            for (Projector* projector: projectors) {
+                projector->calculateCanvasEdges();
+                projector->searchShapeIndexFromToAndValueMinMax();
+            }
+            bool finish = false;
+            while (!finish) {
+                finish = true;
+                for (const Projector* projector: projectors) {
+                    for (const Alignment& alignment: alignments) {                    
+                        if (
+                            (
+                                alignment.getProjector() == projector ||
+                                alignment.getAlignToProjector() == projector
+                            ) && !alignment.fitProjectorsCanvas()
+                        ) finish = false;
+                    }
+                }
+            }
+
+            // one batch of X requests per projector
+            const bool batch = gfx->hasWindow();
+            for (Projector* projector: projectors)
+                if (!projector->getCanvas().stretched) continue;
+                // else if (!projector->isPrepared()) continue;
+                else {
+                    if (batch) gfx->beginBatch();
+                    projector->project();
+                    if (batch) gfx->flushBatch();
+                }
+
+            drawTimeRange();
+        }
+
+        // shapes are owned here and released together by clearProjectors()
+        // (the shapes have no virtual members, so the point and candle
+        // arenas reset without running any destructor)
+        static_assert(is_trivially_destructible<PointShape>::value, "PointShape has to stay trivially destructible");
+        static_assert(is_trivially_destructible<CandleShape>::value, "CandleShape has to stay trivially destructible");
+        Arena<PointShape> pointShapes;
+        Arena<CandleShape> candleShapes;
+        Arena<LabelShape> labelShapes;
         
         void drawTimeRange() {
             TextSize textSize;
@@ -182,14 +254,11 @@ namespace madlib::graph {
         }
 
         virtual ~Chart() {
+            if (drawCache.pixmap) gfx->freePixmap(drawCache.pixmap);
             vector_destroy(pointSeriesProjectors);
             vector_destroy(candleSeriesProjectors);
             vector_destroy(labelSeriesProjectors);
             projectors.clear();
-
-            vector_destroy(pointShapes);
-            vector_destroy(candleShapes);
-            vector_destroy(labelShapes);
             alignments.clear();
         }
 
@@ -200,16 +269,18 @@ namespace madlib::graph {
         void setTimeRangeFullAndApply(const TimeRange& newTimeRangeFull) {
             timeRangeFull->apply(newTimeRangeFull);
             timeRange->apply(*timeRangeFull);
+            invalidate();
         }
 
         virtual void clearProjectors() {
-            vector_destroy(pointShapes);
+            invalidate();
+            pointShapes.reset();
             for (PointSeries* pointSeriesProjector: pointSeriesProjectors)
                 pointSeriesProjector->clearShapes();
-            vector_destroy(candleShapes);
+            candleShapes.reset();
             for (CandleSeries* candleSeriesProjector: candleSeriesProjectors)
                 candleSeriesProjector->clearShapes();
-            vector_destroy(labelShapes);
+            labelShapes.reset();
             for (LabelSeries* labelSeriesProjector: labelSeriesProjectors)
                 labelSeriesProjector->clearShapes();
         };
@@ -218,42 +289,72 @@ namespace madlib::graph {
             this->multiChart = multiChart;
         }
 
+        /**
+         * Renders into an offscreen pixmap and blits the visible part.
+         * While the chart is not invalidated and its visible part, time
+         * range and series content versions are the same, only the blit
+         * happens (e.g. when a parent area is redrawn or scrolled), and
+         * not even that while nothing painted over it.
+         */
         virtual void draw() override {
-            TimeRangeArea::draw();
-
-            // for (const Alignment& alignment: alignments) {
-            //     LOG("Aligning: " + to_string((unsigned long long)alignment.getProjector()) + " to: " + to_string((unsigned long long)alignment.getAlignToProjector()));
-            //     alignment.getProjector()->align(
-            //         alignment.getAlignToProjector(), 
-            //         alignment.isExtends()
-            //     );
-            // }
-
-            for (Projector* projector: projectors) {
-                projector->calculateCanvasEdges();
-                projector->searchShapeIndexFromToAndValueMinMax();
+            if (!gfx->hasWindow()) {
+                exposed = true; // the time range may have changed without invalidating
+                drawContent();
+                return;
             }
-            bool finish = false;
-            while (!finish) {
-                finish = true;
-                for (const Projector* projector: projectors) {
-                    for (const Alignment& alignment: alignments) {                    
-                        if (
-                            (
-                                alignment.getProjector() == projector ||
-                                alignment.getAlignToProjector() == projector
-                            ) && !alignment.fitProjectorsCanvas()
-                        ) finish = false;
-                    }
-                }
+
+            Viewport area;
+            getViewport(area);
+            Viewport visible = area;
+            if (!reduceViewport(visible)) return;
+            const size_t content = getContentVersion();
+            const int pixmapWidth = area.x2 - area.x1 + 1;
+            const int pixmapHeight = area.y2 - area.y1 + 1;
+
+            // a complete rendering can be blitted anywhere (e.g. the accordion scrolled)
+            const bool samePlace = 
+                sameViewport(drawCache.area, area) &&
+                sameViewport(drawCache.visible, visible);
+            const bool completeSameSize = 
+                sameViewport(drawCache.area, drawCache.visible) &&
+                drawCache.width == pixmapWidth && drawCache.height == pixmapHeight;
+            if (
+                !dirty && drawCache.pixmap &&
+                (samePlace || completeSameSize) &&
+                drawCache.begin == timeRange->begin &&
+                drawCache.end == timeRange->end &&
+                drawCache.content == content
+            ) {
+                if (exposed || !samePlace) gfx->copyToWindow(drawCache.pixmap, area.x1, area.y1, visible);
+                drawCache.area = area;
+                drawCache.visible = visible;
+                drawn();
+                return;
             }
 
-            for (Projector* projector: projectors)
-                if (!projector->getCanvas().stretched) continue;
-                // else if (!projector->isPrepared()) continue;
-                else projector->project();
+            if (!drawCache.pixmap || drawCache.width != pixmapWidth || drawCache.height != pixmapHeight) {
+                if (drawCache.pixmap) gfx->freePixmap(drawCache.pixmap);
+                drawCache.pixmap = gfx->createPixmap(pixmapWidth, pixmapHeight);
+                drawCache.width = pixmapWidth;
+                drawCache.height = pixmapHeight;
+            }
 
-            drawTimeRange();
+            exposed = true; // the time range may have changed without invalidating
+            gfx->beginOffscreen(drawCache.pixmap, area.x1, area.y1);
+            try {
+                drawContent();
+            } catch (...) {
+                gfx->endOffscreen();
+                throw;
+            }
+            gfx->endOffscreen();
+            gfx->copyToWindow(drawCache.pixmap, area.x1, area.y1, visible);
+
+            drawCache.area = area;
+            drawCache.visible = visible;
+            drawCache.begin = timeRange->begin;
+            drawCache.end = timeRange->end;
+            drawCache.content = content;
         }
 
         virtual PointSeries* createPointSeries(
@@ -261,6 +362,7 @@ namespace madlib::graph {
             // bool alignExtends = true,
             Color color = Theme::defaultChartSeriesColor
         ) {
+            invalidate();
             PointSeries* pointSeries = new PointSeries(
                 this, color
             );
@@ -283,6 +385,7 @@ namespace madlib::graph {
             Color colorUp = Theme::defaultChartCandleColorUp, 
             Color colorDown = Theme::defaultChartCandleColorDown
         ) {
+            invalidate();
             CandleSeries* candleSeries = new CandleSeries(
                 this, colorUp, colorDown
             );
@@ -296,6 +399,7 @@ namespace madlib::graph {
             Projector* alignToProjector = nullptr //,
             // bool alignExtends = true
         ) {
+            invalidate();
             LabelSeries* labelSeries = new LabelSeries(this);
             labelSeriesProjectors.push_back(labelSeries);
             projectors.push_back(labelSeries);
@@ -307,11 +411,9 @@ namespace madlib::graph {
             ms_t time, 
             double value
         ) {
-            PointShape* pointShape = new PointShape(
+            return pointShapes.create(
                 time, value
             );
-            pointShapes.push_back(pointShape);
-            return pointShape;
         }
 
         CandleShape* createCandleShape(
@@ -322,11 +424,9 @@ namespace madlib::graph {
             double high,
             double close
         ) {
-            CandleShape* candleShape = new CandleShape(
+            return candleShapes.create(
                 begin, end, open, low, high, close
             );
-            candleShapes.push_back(candleShape);
-            return candleShape;
         }
 
         LabelShape* createLabelShape(
@@ -338,13 +438,11 @@ namespace madlib::graph {
             const int padding = Theme::defaultChartLabelPadding,
             const bool hasBackground = Theme::defaultChartLabelHasBackground
         ) {
-            LabelShape* labelShape = new LabelShape(
+            return labelShapes.create(
                 time, value, text, 
                 color, backgroundColor,
                 padding, hasBackground
             );
-            labelShapes.push_back(labelShape);
-            return labelShape;
         }
     };
 
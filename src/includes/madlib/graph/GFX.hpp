@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/cursorfont.h>
@@ -10,6 +13,7 @@
 
 #include "defs.hpp"
 #include "Color.hpp"
+#include "GlyphMetrics.hpp"
 #include "Theme.hpp"
 #include "EventHandler.hpp"
 
@@ -25,9 +29,49 @@ namespace madlib::graph {
         GC gc;
         const char* font = nullptr;
         XFontStruct *fontInfo = nullptr;
+        GlyphMetrics glyphMetrics; // of the fontInfo
 
         Viewport viewport;
 
+        // drawing goes to the window or to an offscreen pixmap (see beginOffscreen()),
+        // the coordinates are always window coordinates
+        Drawable target = 0;
+        int targetLeft = 0, targetTop = 0; // window position of the target origin
+        vector<Pixmap> pixmaps; // released with the window
+
+        // segments and rectangles collected per colour between beginBatch() and flushBatch(),
+        // the coordinates are already clipped and relative to the target
+        struct Batch {
+            Color color;
+            vector<XSegment> segments;
+            vector<XRectangle> rectangles;
+        };
+        vector<Batch> batches;
+        bool batching = false;
+        mutable Color color = 0;
+
+        Batch& getBatch() {
+            for (Batch& batch: batches)
+                if (batch.color == color) return batch;
+            batches.push_back({ color, {}, {} });
+            return batches.back();
+        }
+
+        vector<XPoint> polylinePoints;
+
+        void drawPolylinePoints() {
+            if (polylinePoints.size() > 1)
+                XDrawLines(display, target, gc, polylinePoints.data(), (int)polylinePoints.size(), CoordModeOrigin);
+            polylinePoints.clear();
+        }
+
+        void addSegment(int x1, int y1, int x2, int y2) {
+            getBatch().segments.push_back({
+                (short)(x1 - targetLeft), (short)(y1 - targetTop), 
+                (short)(x2 - targetLeft), (short)(y2 - targetTop)
+            });
+        }
+
         void* context = nullptr;
 
         bool closing = false;
@@ -59,6 +103,28 @@ namespace madlib::graph {
         // }
 
         void setColor(Color color) const {
+            this->color = color;
+            if (!batching) XSetForeground(display, gc, color);
+        }
+
+        // the line and filled rectangle drawings are collected until flushBatch(),
+        // every other drawing flushes the batch first to keep the drawing order
+        void beginBatch() {
+            batching = true;
+        }
+
+        void flushBatch() {
+            batching = false;
+            for (Batch& batch: batches) {
+                if (batch.segments.empty() && batch.rectangles.empty()) continue;
+                XSetForeground(display, gc, batch.color);
+                if (!batch.rectangles.empty())
+                    XFillRectangles(display, target, gc, batch.rectangles.data(), (int)batch.rectangles.size());
+                if (!batch.segments.empty())
+                    XDrawSegments(display, target, gc, batch.segments.data(), (int)batch.segments.size());
+                batch.segments.clear();
+                batch.rectangles.clear();
+            }
             XSetForeground(display, gc, color);
         }
 
@@ -95,6 +161,8 @@ namespace madlib::graph {
                 ExposureMask | KeyPressMask | KeyReleaseMask | ButtonPressMask | 
                 ButtonReleaseMask | PointerMotionMask);
 
+            target = window;
+
             setFont(font);
             setColor(color);
             clearWindow();
@@ -102,7 +170,10 @@ namespace madlib::graph {
             eventContext = this;
         }
 
-        void closeWindow(bool closeDisplay = true) const {            
+        void closeWindow(bool closeDisplay = true) {            
+            for (Pixmap pixmap: pixmaps) XFreePixmap(display, pixmap);
+            pixmaps.clear();
+            target = 0;
             if (fontInfo) XFreeFont(display, fontInfo);
             XFreeGC(display, gc);            
             XDestroyWindow(display, window);
@@ -134,15 +205,19 @@ namespace madlib::graph {
             // XFlush(display);  // Flush the changes to the server
         }
 
-        void drawPoint(int x, int y) const {
+        void drawPoint(int x, int y) {
+            if (batching) {
+                flushBatch();
+                beginBatch();
+            }
             if (viewport.containsCompletely(x, y, x, y))
-                XDrawPoint(display, window, gc, x, y);
+                XDrawPoint(display, target, gc, x - targetLeft, y - targetTop);
         }
 
-        void drawRectangle(int x1, int y1, int x2, int y2) const {
+        void drawRectangle(int x1, int y1, int x2, int y2) {
             Viewport rect(x1, y1, x2, y2);
-            if (rect.insideOf(viewport)) {
-                XDrawRectangle(display, window, gc, x1, y1, (unsigned)(x2 - x1), (unsigned)(y2 - y1));
+            if (!batching && rect.insideOf(viewport)) {
+                XDrawRectangle(display, target, gc, x1 - targetLeft, y1 - targetTop, (unsigned)(x2 - x1), (unsigned)(y2 - y1));
                 return;
             }
             if (rect.containsPartially(x1, y1, x2, y1)) drawHorizontalLine(x1, y1, x2);
@@ -151,15 +226,21 @@ namespace madlib::graph {
             if (rect.containsPartially(x1, y1, x1, y2)) drawVerticalLine(x1, y1, y2);
         }
 
-        void fillRectangle(int x1, int y1, int x2, int y2) const {
+        void fillRectangle(int x1, int y1, int x2, int y2) {
             Viewport rect(x1, y1, x2, y2);
-            rect.intersect(viewport.x1, viewport.y1, viewport.x2, viewport.y2);
-            XFillRectangle(display, window, gc, rect.x1, rect.y1, (unsigned)(rect.x2 - rect.x1), (unsigned)(rect.y2 - rect.y1));
+            bool inside = rect.intersect(viewport.x1, viewport.y1, viewport.x2, viewport.y2);
+            if (batching) {
+                if (!inside) return;
+                getBatch().rectangles.push_back({
+                    (short)(rect.x1 - targetLeft), (short)(rect.y1 - targetTop), 
+                    (unsigned short)(rect.x2 - rect.x1), (unsigned short)(rect.y2 - rect.y1)
+                });
+                return;
+            }
+            XFillRectangle(display, target, gc, rect.x1 - targetLeft, rect.y1 - targetTop, (unsigned)(rect.x2 - rect.x1), (unsigned)(rect.y2 - rect.y1));
         }
 
-        void drawLine(int x1, int y1, int x2, int y2) const {
-            Viewport rect(x1, y1, x2, y2);
-            
+        void drawLine(int x1, int y1, int x2, int y2) {
             if (x1 == x2) {
                 drawVerticalLine(x1, y1, y2);
                 return;
@@ -170,42 +251,106 @@ namespace madlib::graph {
                 return;
             }
 
-            if (
-                (x1 > viewport.x2 && x2 > viewport.x2) ||
-                (x1 < viewport.x1 && x2 < viewport.x1) ||
-                (y1 > viewport.y2 && y2 > viewport.y2) ||
-                (y1 < viewport.y1 && y2 < viewport.y1)
-            ) {
-                return;
-            }
-
-            // TODO: this part will need only when calculating the edge
-            // // Fix the line first, it's always goes left to right
-            // if (x1 > x2) {
-            //     swap(x1, x2);
-            //     swap(y1, y2);
-            //     rect = Viewport(x1, y1, x2, y2);
-            // }
+            if (!viewport.clipLine(x1, y1, x2, y2)) return;
 
-            if (!viewport.containsCompletely(rect)) {
-                // TODO: cut the line at the edge of viewport
+            // Draw the clipped line
+            if (batching) {
+                addSegment(x1, y1, x2, y2);
                 return;
             }
+            XDrawLine(display, target, gc, x1 - targetLeft, y1 - targetTop, x2 - targetLeft, y2 - targetTop);
+        }
 
-            // Draw the clipped line
-            XDrawLine(display, window, gc, x1, y1, x2, y2);
+        // every segment is clipped, the connected visible parts go out as one XDrawLines request
+        void drawPolyline(const vector<Pixel>& points) {
+            if (points.size() < 2) return;
+            polylinePoints.clear();
+            for (size_t i = 1; i < points.size(); i++) {
+                int x1 = points[i - 1].x, y1 = points[i - 1].y;
+                int x2 = points[i].x, y2 = points[i].y;
+                if (!viewport.clipLine(x1, y1, x2, y2)) continue;
+                if (batching) {
+                    addSegment(x1, y1, x2, y2);
+                    continue;
+                }
+                const short fromX = (short)(x1 - targetLeft), fromY = (short)(y1 - targetTop);
+                if (
+                    polylinePoints.empty() || 
+                    polylinePoints.back().x != fromX || polylinePoints.back().y != fromY
+                ) {
+                    drawPolylinePoints();
+                    polylinePoints.push_back({ fromX, fromY });
+                }
+                polylinePoints.push_back({ (short)(x2 - targetLeft), (short)(y2 - targetTop) });
+            }
+            drawPolylinePoints();
         }
 
-        void drawVerticalLine(int x1, int y1, int y2) const {
+        void drawVerticalLine(int x1, int y1, int y2) {
             Viewport rect(x1, y1, x1, y2);
-            rect.intersect(viewport.x1, viewport.y1, viewport.x2, viewport.y2);
-            XDrawLine(display, window, gc, rect.x1, rect.y1, rect.x1, rect.y2);
+            bool inside = rect.intersect(viewport.x1, viewport.y1, viewport.x2, viewport.y2);
+            if (batching) {
+                if (!inside) return;
+                addSegment(rect.x1, rect.y1, rect.x1, rect.y2);
+                return;
+            }
+            XDrawLine(display, target, gc, rect.x1 - targetLeft, rect.y1 - targetTop, rect.x1 - targetLeft, rect.y2 - targetTop);
         }
         
-        void drawHorizontalLine(int x1, int y1, int x2) const {
+        void drawHorizontalLine(int x1, int y1, int x2) {
             Viewport rect(x1, y1, x2, y1);
-            rect.intersect(viewport.x1, viewport.y1, viewport.x2, viewport.y2);
-            XDrawLine(display, window, gc, rect.x1, rect.y1, rect.x2, rect.y1);
+            bool inside = rect.intersect(viewport.x1, viewport.y1, viewport.x2, viewport.y2);
+            if (batching) {
+                if (!inside) return;
+                addSegment(rect.x1, rect.y1, rect.x2, rect.y1);
+                return;
+            }
+            XDrawLine(display, target, gc, rect.x1 - targetLeft, rect.y1 - targetTop, rect.x2 - targetLeft, rect.y1 - targetTop);
+        }
+
+        bool hasWindow() const {
+            return target != 0;
+        }
+
+        Pixmap createPixmap(int width, int height) {
+            Pixmap pixmap = XCreatePixmap(
+                display, window, (unsigned)width, (unsigned)height,
+                (unsigned)DefaultDepth(display, DefaultScreen(display))
+            );
+            pixmaps.push_back(pixmap);
+            return pixmap;
+        }
+
+        // no-op after the window is closed, the pixmaps are already released then
+        void freePixmap(Pixmap pixmap) {
+            auto it = find(pixmaps.begin(), pixmaps.end(), pixmap);
+            if (it == pixmaps.end()) return;
+            XFreePixmap(display, pixmap);
+            pixmaps.erase(it);
+        }
+
+        // the following drawings go into the pixmap, its origin is at (left, top) of the window
+        void beginOffscreen(Pixmap pixmap, int left, int top) {
+            target = pixmap;
+            targetLeft = left;
+            targetTop = top;
+        }
+
+        void endOffscreen() {
+            if (batching) flushBatch();
+            target = window;
+            targetLeft = 0;
+            targetTop = 0;
+        }
+
+        // blits the rectangle (x1, y1, x2, y2) in window coordinates from a pixmap placed at (left, top)
+        void copyToWindow(Pixmap pixmap, int left, int top, const Viewport& rect) const {
+            XCopyArea(
+                display, pixmap, window, gc,
+                rect.x1 - left, rect.y1 - top,
+                (unsigned)(rect.x2 - rect.x1 + 1), (unsigned)(rect.y2 - rect.y1 + 1),
+                rect.x1, rect.y1
+            );
         }
 
         void setFont(const char* font) { 
@@ -218,6 +363,7 @@ namespace madlib::graph {
                 // LOG("Available fonts:\n\t" + vector_concat(getAvailableFonts(), "\n\t"));
                 throw ERROR("Unable to load font:" + string(font));
             }
+            glyphMetrics.load(*fontInfo);
             XSetFont(display, gc, fontInfo->fid);
         }
         
@@ -243,53 +389,31 @@ namespace madlib::graph {
         }
         
         void writeText(int x, int y, const string& text) {
-            // Cut text to fit into the viewport first
-            string txt = text;
+            if (batching) {
+                flushBatch();
+                beginBatch();
+            }
             if (!fontInfo) setFont(font);
             if (!fontInfo) throw ERROR("No font info");
-            int asc = fontInfo->ascent;
-            int desc = fontInfo->descent;
-            y += asc;
-            while (!txt.empty()) {
-                int width, height;
-                getTextSize(txt, width, height);
-                int x1 = x;
-                int y1 = y + desc;
-                int x2 = x + width;
-                int y2 = y - height + desc;
-                if (x1 > x2) swap(x1, x2);
-                if (y1 > y2) swap(y1, y2);
-                
-                if (y1 < viewport.y1 || y2 > viewport.y2) return;
-                if (x1 < viewport.x1) {
-                    // Extract the first character.
-                    getTextSize(txt.substr(0, 1), width, height); 
-                    x += width;
-                    txt = txt.substr(1); // This removes the first character.
-                    continue;
-                }
-                if (x2 > viewport.x2) {
-                    // Extract the last character.
-                    getTextSize(txt.substr(txt.length() - 1), width, height); 
-                    txt = txt.substr(0, txt.length() - 1); // Remove the last character.
-                    continue;
-                }
-                break;
-            }
+            if (text.empty()) return;
+
+            // Cut text to fit into the viewport first
+            y += glyphMetrics.getAscent();
+            if (
+                y - glyphMetrics.getAscent() < viewport.y1 || 
+                y + glyphMetrics.getDescent() > viewport.y2
+            ) return;
+            size_t begin, end;
+            int offset;
+            if (!glyphMetrics.clip(text, viewport.x1 - x, viewport.x2 - x, begin, end, offset)) return;
             
-            XDrawString(display, window, gc, x, y, txt.c_str(), (int)txt.length());
+            XDrawString(display, target, gc, x + offset - targetLeft, y - targetTop, text.c_str() + begin, (int)(end - begin));
         }
 
         void getTextSize(const string &text, int &width, int &height) const {            
             if (fontInfo) {
-                XCharStruct overall;
-                int direction, ascent, descent; // TODO: add these retrievable
-                
-                XTextExtents(fontInfo, text.c_str(), (int)text.length(), &direction, &ascent, &descent, &overall);
-                
-                // The width and height are calculated based on the text extents
-                width = overall.width;
-                height = ascent + descent;
+                width = glyphMetrics.width(text);
+                height = glyphMetrics.getHeight();
                 return;
             }
             // Handle the case where the font is not set
@@ -11,22 +11,26 @@ namespace madlib::graph {
             GUI* that = (GUI*)(context);
             that->width = width;
             that-> height = height;
+            that->invalidate();
             that->draw();
         }
 
         static void touchHandler(void* context, unsigned int button, int x, int y) {
             Area* that = (Area*)(context);
             that->propagateTouch(button, x, y);
+            that->draw(); // what the handlers invalidated
         }
 
         static void releaseHandler(void* context, unsigned int button, int x, int y) {
             Area* that = (Area*)(context);
             that->propagateRelease(button, x, y);
+            that->draw();
         }
 
         static void moveHandler(void* context, int x, int y) {
             Area* that = (Area*)(context);
             that->propagateMove(x, y);
+            that->draw();
         }
 
         void init(
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <X11/Xlib.h>
+
+using namespace std;
+
+namespace madlib::graph {
+
+    /**
+     * Advance widths of the single byte characters of a font, read once
+     * from the per character metrics of the XFontStruct. Text widths are
+     * table lookups (the same sums XTextExtents() does on the client side)
+     * and clipping is a binary search on the prefix widths.
+     */
+    class GlyphMetrics {
+    protected:
+        int advances[256] = {};
+        int ascent = 0;
+        int descent = 0;
+
+        mutable vector<int> prefix; // reused by clip()
+
+        static const XCharStruct* charStruct(const XFontStruct& fontInfo, unsigned int c) {
+            if (c < fontInfo.min_char_or_byte2 || c > fontInfo.max_char_or_byte2) return nullptr;
+            if (!fontInfo.per_char) return &fontInfo.max_bounds;
+            const XCharStruct* cs = &fontInfo.per_char[c - fontInfo.min_char_or_byte2];
+            // all zero metrics mean a missing glyph
+            if (!cs->width && !cs->ascent && !cs->descent && !cs->lbearing && !cs->rbearing) return nullptr;
+            return cs;
+        }
+
+    public:
+
+        GlyphMetrics() {}
+
+        explicit GlyphMetrics(const XFontStruct& fontInfo) {
+            load(fontInfo);
+        }
+
+        virtual ~GlyphMetrics() {}
+
+        void load(const XFontStruct& fontInfo) {
+            ascent = fontInfo.ascent;
+            descent = fontInfo.descent;
+            const XCharStruct* defaultChar = charStruct(fontInfo, fontInfo.default_char);
+            for (unsigned int c = 0; c < 256; c++) {
+                const XCharStruct* cs = charStruct(fontInfo, c);
+                if (!cs) cs = defaultChar;
+                advances[c] = cs ? cs->width : 0;
+            }
+        }
+
+        int getAscent() const {
+            return ascent;
+        }
+
+        int getDescent() const {
+            return descent;
+        }
+
+        int getHeight() const {
+            return ascent + descent;
+        }
+
+        int advance(char c) const {
+            return advances[(unsigned char)c];
+        }
+
+        int width(const char* text, size_t length) const {
+            int sum = 0;
+            for (size_t i = 0; i < length; i++) sum += advance(text[i]);
+            return sum;
+        }
+
+        int width(const string& text) const {
+            return width(text.c_str(), text.length());
+        }
+
+        /**
+         * The longest substring [begin, end) that fits between minX and maxX
+         * (relative to the text origin) when it is drawn at its original place,
+         * offset is the width of the cut off beginning.
+         */
+        bool clip(const string& text, int minX, int maxX, size_t& begin, size_t& end, int& offset) const {
+            prefix.resize(text.length() + 1);
+            prefix[0] = 0;
+            for (size_t i = 0; i < text.length(); i++) prefix[i + 1] = prefix[i] + advance(text[i]);
+            begin = (size_t)(lower_bound(prefix.begin(), prefix.end(), minX) - prefix.begin());
+            end = (size_t)(upper_bound(prefix.begin(), prefix.end(), maxX) - prefix.begin());
+            if (end > 0) end--;
+            if (begin >= text.length() || end <= begin) {
+                begin = end = 0;
+                offset = 0;
+                return false;
+            }
+            offset = prefix[begin];
+            return true;
+        }
+    };
+
+}
\ No newline at end of file
@@ -91,6 +91,7 @@ namespace madlib::graph {
             that->value = that->calcValue();
             // that->valueSize = ... // TODO calcValueSize
             // logger.writeln(that->value, ", ", that->valueSize);
+            that->invalidate();
             that->draw();
         }
 
@@ -63,6 +63,7 @@ namespace madlib::graph {
         virtual void rect(int, int, int, int) { throw ERR_UNIMP; }
         virtual void fRect(int, int, int, int) { throw ERR_UNIMP; }
         virtual void line(int, int, int, int) { throw ERR_UNIMP; }
+        virtual void polyline(vector<Pixel>&) { throw ERR_UNIMP; }
         virtual void hLine(int, int, int) { throw ERR_UNIMP; }
         virtual void vLine(int, int, int) { throw ERR_UNIMP; }
         virtual void write(int, int, const string&) { throw ERR_UNIMP; }
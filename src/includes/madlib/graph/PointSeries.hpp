@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
+
 #include "defs.hpp"
 #include "TimeRangeArea.hpp"
 #include "Color.hpp"
 #include "Projector.hpp"
 #include "PointShape.hpp"
+#include "TimeSeries.hpp"
 
 namespace madlib::graph {
     
@@ -13,23 +16,37 @@ namespace madlib::graph {
     
         const Color color;
 
+        // projected instead of the shapes when set
+        const TimeSeries* timeSeries = nullptr;
+        TimeSeries points; // see addPoint()
+        mutable size_t timeSeriesVersion = 0; // of the time series when the version was last bumped
+        vector<Pixel> polyline; // reused by project()
+
+        ms_t timeAt(size_t i) const {
+            return timeSeries ? timeSeries->time(i) : ((const PointShape*)shapes[i])->time();
+        }
+
+        double valueAt(size_t i) const {
+            return timeSeries ? timeSeries->value(i) : ((const PointShape*)shapes[i])->value();
+        }
+
         void projectFirstLastValue() {
             string text;
             
-            const PointShape* first = (const PointShape*)shapes[canvas.shapeIndexFrom];
-            text = to_string(first->value());
+            double first = valueAt(canvas.shapeIndexFrom);
+            text = to_string(first);
             TextSize textSize = timeRangeArea->getTextSize(text);
             timeRangeArea->write(
                 -textSize.width, 
-                canvas.chartHeight - translateY(first->value()), 
+                canvas.chartHeight - translateY(first), 
                 text
             );
 
-            const PointShape* last = (const PointShape*)shapes[canvas.shapeIndexTo];
-            text = to_string(last->value());
+            double last = valueAt(canvas.shapeIndexTo);
+            text = to_string(last);
             timeRangeArea->write(
                 canvas.chartWidth, 
-                canvas.chartHeight - translateY(last->value()), 
+                canvas.chartHeight - translateY(last), 
                 text
             );
         }
@@ -46,33 +63,70 @@ namespace madlib::graph {
 
         virtual ~PointSeries() {}
 
-        virtual void project() override {
-            const PointShape* first = (const PointShape*)shapes[canvas.shapeIndexFrom];
+        const TimeSeries* getTimeSeries() const {
+            return timeSeries;
+        }
 
-            Pixel prev = translate(
-                first->time(), 
-                first->value()
-            );
+        void setTimeSeries(const TimeSeries* timeSeries) {
+            this->timeSeries = timeSeries;
+            timeSeriesVersion = timeSeries ? timeSeries->getVersion() : 0;
+            version++;
+        }
+
+        virtual size_t size() const override {
+            return timeSeries ? timeSeries->size() : shapes.size();
+        }
+
+        // the time series may be changed by its owner (e.g. the backtester)
+        virtual size_t getVersion() const override {
+            if (timeSeries && timeSeries->getVersion() != timeSeriesVersion) {
+                timeSeriesVersion = timeSeries->getVersion();
+                version++;
+            }
+            return version;
+        }
+
+        // value-typed points, projected instead of the shapes
+        void addPoint(ms_t time, double value) {
+            if (timeSeries && timeSeries != &points) throw ERROR("Point series projects an external time series");
+            timeSeries = &points;
+            points.push_back(time, value);
+        }
+
+        void reservePoints(size_t size) {
+            points.reserve(size);
+        }
+
+        virtual bool searchShapeIndexFromToAndValueMinMax() override {
+            if (!timeSeries) return Projector::searchShapeIndexFromToAndValueMinMax();
+            const ms_t* times = timeSeries->getTimes()->data();
+            auto timeAt = [times](size_t i) { return times[i]; };
+            if (!searchIndexFromTo(timeSeries->size(), timeAt, timeAt)) return false;
+            return stretchToValueMinMax(timeSeries->getValueIndex());
+        }
+
+        virtual void project() override {
             timeRangeArea->brush(color);
             
             size_t step = (canvas.shapeIndexTo - canvas.shapeIndexFrom) / (size_t)canvas.chartWidth;
             if (step < 1) step = 1;
-            for (size_t i = canvas.shapeIndexFrom; i < canvas.shapeIndexTo; i += step) {
-                const PointShape* point = (const PointShape*)shapes[i];
-                Pixel pixel = translate(
-                    point->time(), 
-                    point->value()
-                );
-
-                timeRangeArea->line(
-                    prev.x, canvas.chartHeight - prev.y, 
-                    pixel.x, canvas.chartHeight - pixel.y
-                );
-                prev = pixel;
-            }
+            polyline.clear();
+            polyline.reserve((canvas.shapeIndexTo - canvas.shapeIndexFrom) / step + 1);
+            for (size_t i = canvas.shapeIndexFrom; i < canvas.shapeIndexTo; i += step)
+                polyline.push_back(translate(
+                    timeAt(i), 
+                    valueAt(i)
+                ));
+            for (Pixel& pixel: polyline) pixel.y = canvas.chartHeight - pixel.y;
+            timeRangeArea->polyline(polyline);
 
             projectFirstLastValue();
         }
+
+        virtual void clearShapes() override {
+            Projector::clearShapes();
+            points.clear();
+        }
     };
 
 }
\ No newline at end of file
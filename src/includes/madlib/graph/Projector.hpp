@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../RangeMinMax.hpp"
+
 #include "Shape.hpp"
 #include "Chart.hpp"
 
@@ -44,6 +46,63 @@ namespace madlib::graph {
         TimeRangeArea* timeRangeArea = nullptr;
         vector<Shape*> shapes;
 
+        // value extremes of the shapes, extended with the shapes appended since the last search
+        RangeMinMax<> shapesValueIndex;
+
+        // bumped by every change of the projected elements, see getVersion()
+        mutable size_t version = 0;
+
+        // bumped by the mutable getShapes() only, any shape may have changed since
+        size_t shapesEdits = 0;
+
+        /**
+         * Visible index range over a time ordered storage, the accessors
+         * give the begin/end time of the i-th element. Both bounds are
+         * binary searched: [from, to) where the last element only closes
+         * the range (as the original linear scan did).
+         */
+        template<typename Begin, typename End>
+        bool searchIndexFromTo(size_t size, Begin beginAt, End endAt) {
+            canvas.shapesValueMin = INFINITY;
+            canvas.shapesValueMax = -INFINITY;
+            canvas.shapeIndexFrom = __SIZE_MAX__;
+            canvas.shapeIndexTo = 0;
+            canvas.stretched = false;
+            if (size == 0) return false;
+            const size_t lastIndex = size - 1;
+            size_t from = 0;
+            for (size_t count = lastIndex; count > 0;) { // first end >= chartBegin
+                const size_t half = count / 2;
+                if (endAt(from + half) < canvas.chartBegin) {
+                    from += half + 1;
+                    count -= half + 1;
+                } else count = half;
+            }
+            size_t to = from;
+            for (size_t count = lastIndex - from; count > 0;) { // first begin > chartEnd
+                const size_t half = count / 2;
+                if (beginAt(to + half) <= canvas.chartEnd) {
+                    to += half + 1;
+                    count -= half + 1;
+                } else count = half;
+            }
+            canvas.shapeIndexTo = to;
+            if (from >= to) return false;
+            canvas.shapeIndexFrom = from;
+            return true;
+        }
+
+        // value extremes of the found index range from an index
+        template<size_t BLOCK_SIZE>
+        bool stretchToValueMinMax(const RangeMinMax<BLOCK_SIZE>& valueIndex) {
+            if (!valueIndex.query(
+                canvas.shapeIndexFrom, canvas.shapeIndexTo,
+                canvas.shapesValueMin, canvas.shapesValueMax
+            )) return false;
+            canvas.shapesValueDiff = canvas.shapesValueMax - canvas.shapesValueMin;
+            return canvas.stretched = true;
+        }
+
     public:
 
         explicit Projector(
@@ -68,10 +127,41 @@ namespace madlib::graph {
             return timeRangeArea;
         }
 
+        /**
+         * Mutable access to the shapes, the shapes may be changed in any way
+         * so the value index is rebuilt on the next search.
+         * Use addShape() to append and keep the index incremental.
+         */
         vector<Shape*>& getShapes() {
+            shapesValueIndex.clear();
+            shapesEdits++;
+            version++;
+            return shapes;
+        }
+
+        const vector<Shape*>& getShapes() const {
             return shapes;
         }
 
+        void addShape(Shape* shape) {
+            shapes.push_back(shape);
+            version++;
+        }
+
+        // number of the elements projected
+        virtual size_t size() const {
+            return shapes.size();
+        }
+
+        /**
+         * Grows on every change of the projected elements, also when the
+         * count stays the same (e.g. a live last candle or replaced shapes),
+         * so a chart knows when its cached rendering is stale.
+         */
+        virtual size_t getVersion() const {
+            return version;
+        }
+
         virtual void project() {
             throw ERR_UNIMP;
         }
@@ -176,57 +266,24 @@ namespace madlib::graph {
             canvas.chartInterval = canvas.chartEnd - canvas.chartBegin;
         }
 
-        bool searchShapeIndexFromToAndValueMinMax() {
-            // TODO: binary search to get the first index
-            canvas.shapesValueMin = INFINITY;
-            canvas.shapesValueMax = -INFINITY;
-            canvas.shapeIndexFrom = __SIZE_MAX__;
-            canvas.shapeIndexTo = 0;
-            canvas.stretched = false;
-            if (shapes.size() == 0) return false;
-            const size_t shapesLastIndex = shapes.size() - 1;
-            for (
-                canvas.shapeIndexTo = guessFirstShapeIndex(shapesLastIndex);
-                canvas.shapeIndexTo < shapesLastIndex;
-                canvas.shapeIndexTo++
-            ) {
-                Shape* shape = shapes[canvas.shapeIndexTo];
-
-                TimeRange shapeTimeRange = shape->getTimeRange();
-                if (shapeTimeRange.end < canvas.chartBegin) continue;
-                if (shapeTimeRange.begin > canvas.chartEnd) break;
-
-                if (canvas.shapeIndexFrom == __SIZE_MAX__) canvas.shapeIndexFrom = canvas.shapeIndexTo;
-
-                MinMax<double> valueMinMax = shape->getValueMinMax();
-                if (canvas.shapesValueMin > valueMinMax.min) canvas.shapesValueMin = valueMinMax.min;
-                if (canvas.shapesValueMax < valueMinMax.max) canvas.shapesValueMax = valueMinMax.max;
-
+        virtual bool searchShapeIndexFromToAndValueMinMax() {
+            const Shape* const* data = shapes.data();
+            for (size_t i = shapesValueIndex.size(); i < shapes.size(); i++) {
+                const MinMax<double> valueMinMax = data[i]->getValueMinMax();
+                shapesValueIndex.push_back(valueMinMax.min, valueMinMax.max);
             }
-            if (canvas.shapeIndexFrom == __SIZE_MAX__) return false; //canvas.shapeIndexTo = 0;
-
-            canvas.shapesValueDiff = canvas.shapesValueMax - canvas.shapesValueMin;
-            return canvas.stretched = true;
-        }
-
-        // Recursive binary search with linear interpolation, 
-        // assuming a uniform distribution for evenly distributed time series data.
-        size_t guessFirstShapeIndex(size_t shapesLastIndex) const {
-            double shape0Begin = (double)shapes[0]->getTimeRange().begin;
-            long guess = (long)(
-                (((double)canvas.chartBegin - shape0Begin) * (double)shapesLastIndex) / 
-                ((double)shapes[shapesLastIndex]->getTimeRange().end - shape0Begin)
-            ) - 1;
-            if (guess < 1) return 0;
-            size_t guessedFirstShapeIndex = (size_t)guess;
-            if (guessedFirstShapeIndex >= shapesLastIndex) return shapesLastIndex;
-            if (shapes[guessedFirstShapeIndex]->getTimeRange().end >= canvas.chartBegin) 
-                return guessFirstShapeIndex(guessedFirstShapeIndex);
-            return guessedFirstShapeIndex;
+            if (!searchIndexFromTo(
+                shapes.size(),
+                [data](size_t i) { return data[i]->getTimeRange().begin; },
+                [data](size_t i) { return data[i]->getTimeRange().end; }
+            )) return false;
+            return stretchToValueMinMax(shapesValueIndex);
         }
 
         virtual void clearShapes() {
             shapes.clear();
+            shapesValueIndex.clear();
+            version++;
             // prepared = false;
         }
     };
@@ -77,6 +77,14 @@ namespace madlib::graph {
             Area::line(x1 + margin.left, y1 + margin.top, x2 + margin.left, y2 + margin.top);
         }
 
+        virtual void polyline(vector<Pixel>& points) override {
+            for (Pixel& point: points) {
+                point.x += margin.left;
+                point.y += margin.top;
+            }
+            Area::polyline(points);
+        }
+
         virtual void hLine(int x1, int y1, int x2) override {
             Area::hLine(x1 + margin.left, y1 + margin.top, x2 + margin.left);
         }
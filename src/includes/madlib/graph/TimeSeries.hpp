@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+
+#include "../../../../libs/clib/clib/err.hpp"
+
+#include "../RangeMinMax.hpp"
+
+#include "geo.hpp"
+
+using namespace std;
+
+namespace madlib::graph {
+
+    /**
+     * Values keyed by index in a contiguous column, the times are
+     * borrowed from a shared column (e.g. the candle ends), so a value
+     * per candle costs one double instead of a heap allocated shape.
+     * Without a borrowed column the series keeps its own times
+     * (see push_back(time, value)).
+     */
+    class TimeSeries {
+    protected:
+        const vector<ms_t>* times = nullptr;
+        vector<ms_t> ownTimes;
+        vector<double> values;
+        mutable RangeMinMax<> valueIndex; // caught up on demand, see getValueIndex()
+        size_t version = 0; // bumped on every change, see getVersion()
+
+    public:
+
+        TimeSeries() {}
+
+        virtual ~TimeSeries() {}
+
+        void setTimes(const vector<ms_t>* times) {
+            this->times = times;
+            version++;
+        }
+
+        const vector<ms_t>* getTimes() const {
+            return times ? times : &ownTimes;
+        }
+
+        const vector<double>& getValues() const {
+            return values;
+        }
+
+        void reserve(size_t size) {
+            if (!times) ownTimes.reserve(size);
+            values.reserve(size);
+        }
+
+        void clear() {
+            ownTimes.clear();
+            values.clear();
+            valueIndex.clear();
+            version++;
+        }
+
+        // changes whenever the values do (e.g. cleared and refilled to the same size)
+        size_t getVersion() const {
+            return version;
+        }
+
+        // range extremes over the values, only the values added since the last call are indexed
+        const RangeMinMax<>& getValueIndex() const {
+            if (valueIndex.size() > values.size()) valueIndex.clear();
+            for (size_t i = valueIndex.size(); i < values.size(); i++)
+                valueIndex.push_back(values[i], values[i]);
+            return valueIndex;
+        }
+
+        // value at the next index of the borrowed times
+        void push_back(double value) {
+            values.push_back(value);
+            version++;
+        }
+
+        // value with its own time, in time order
+        void push_back(ms_t time, double value) {
+            if (times) throw ERROR("Time series has borrowed times");
+            ownTimes.push_back(time);
+            values.push_back(value);
+            version++;
+        }
+
+        // only the indexes that have both time and value
+        size_t size() const {
+            const size_t timesSize = getTimes()->size();
+            return values.size() < timesSize ? values.size() : timesSize;
+        }
+
+        bool empty() const {
+            return !size();
+        }
+
+        ms_t time(size_t i) const {
+            return (*getTimes())[i];
+        }
+
+        double value(size_t i) const {
+            return values[i];
+        }
+    };
+
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+
 #include "../../../../libs/clib/clib/time.hpp"
 
 using namespace clib;
@@ -103,6 +105,46 @@ namespace madlib::graph {
             return containsPartially(other.x1, other.y1, other.x2, other.y2);
         }
 
+        /**
+         * Liang-Barsky clipping of the line (x1, y1) - (x2, y2) to the rectangle
+         * (edges included), the endpoints are moved onto the edges.
+         * Returns false when no part of the line is inside.
+         */
+        bool clipLine(T& x1, T& y1, T& x2, T& y2) const {
+            const double dx = (double)(x2 - x1);
+            const double dy = (double)(y2 - y1);
+            const double p[4] = { -dx, dx, -dy, dy };
+            const double q[4] = { 
+                (double)(x1 - this->x1), (double)(this->x2 - x1), 
+                (double)(y1 - this->y1), (double)(this->y2 - y1) 
+            };
+            double t0 = 0, t1 = 1;
+            for (int i = 0; i < 4; i++) {
+                if (p[i] == 0) {
+                    if (q[i] < 0) return false; // parallel and outside
+                    continue;
+                }
+                const double t = q[i] / p[i];
+                if (p[i] < 0) {
+                    if (t > t1) return false;
+                    if (t > t0) t0 = t;
+                } else {
+                    if (t < t0) return false;
+                    if (t < t1) t1 = t;
+                }
+            }
+            const T fromX = x1, fromY = y1;
+            if (t1 < 1) {
+                x2 = (T)round((double)fromX + t1 * dx);
+                y2 = (T)round((double)fromY + t1 * dy);
+            }
+            if (t0 > 0) {
+                x1 = (T)round((double)fromX + t0 * dx);
+                y1 = (T)round((double)fromY + t0 * dy);
+            }
+            return true;
+        }
+
         bool contains(T x, T y) {
             return containsPartially(x, y, x, y);
         }
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define MADLIB_SIMD
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define MADLIB_SIMD
+#endif
+
+namespace madlib::simd {
+
+    // packed doubles of the widest instruction set the build targets,
+    // loops process the width-aligned part with these and the tail with plain doubles
+#if defined(__AVX2__)
+
+    typedef __m256d vec;
+    const size_t width = 4;
+
+    inline vec load(const double* p) { return _mm256_loadu_pd(p); }
+    inline void store(double* p, vec a) { _mm256_storeu_pd(p, a); }
+    inline vec set1(double a) { return _mm256_set1_pd(a); }
+    inline vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+    inline vec sub(vec a, vec b) { return _mm256_sub_pd(a, b); }
+    inline vec mul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+    inline vec div(vec a, vec b) { return _mm256_div_pd(a, b); }
+    inline vec min(vec a, vec b) { return _mm256_min_pd(a, b); }
+    inline vec max(vec a, vec b) { return _mm256_max_pd(a, b); }
+    inline vec sqrt(vec a) { return _mm256_sqrt_pd(a); }
+    inline vec abs(vec a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+
+#elif defined(__SSE2__)
+
+    typedef __m128d vec;
+    const size_t width = 2;
+
+    inline vec load(const double* p) { return _mm_loadu_pd(p); }
+    inline void store(double* p, vec a) { _mm_storeu_pd(p, a); }
+    inline vec set1(double a) { return _mm_set1_pd(a); }
+    inline vec add(vec a, vec b) { return _mm_add_pd(a, b); }
+    inline vec sub(vec a, vec b) { return _mm_sub_pd(a, b); }
+    inline vec mul(vec a, vec b) { return _mm_mul_pd(a, b); }
+    inline vec div(vec a, vec b) { return _mm_div_pd(a, b); }
+    inline vec min(vec a, vec b) { return _mm_min_pd(a, b); }
+    inline vec max(vec a, vec b) { return _mm_max_pd(a, b); }
+    inline vec sqrt(vec a) { return _mm_sqrt_pd(a); }
+    inline vec abs(vec a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+
+#else
+
+    const size_t width = 1;
+
+#endif
+
+}
\ No newline at end of file
@@ -35,6 +35,15 @@ namespace madlib::trading {
             return amount;
         }
 
+        // the same checks as increment()/decrement() without changing the amount
+        bool canIncrement(double increment) const {
+            return canGoNegative || amount + increment >= 0.0;
+        }
+
+        bool canDecrement(double decrement) const {
+            return canGoNegative || amount - decrement >= 0.0;
+        }
+
         bool increment(double increment, bool throws = true) {
             amount += increment;
             if (checkIfNegative(throws)) {
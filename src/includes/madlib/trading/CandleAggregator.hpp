@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../../../libs/clib/clib/time.hpp"
+#include "../../../../libs/clib/clib/err.hpp"
+
+#include "Candle.hpp"
+#include "CandleStore.hpp"
+
+using namespace std;
+using namespace clib;
+
+namespace madlib::trading {
+
+    /**
+     * Streaming resampler, candles have to be added in ascending time
+     * and are collected into buckets of the target period (aligned to
+     * the epoch, or to Monday 00:00 UTC for whole weeks), every finished
+     * bucket is pushed to the output.
+     */
+    class CandleAggregator {
+    protected:
+        ms_t period;
+        vector<Candle>& candles;
+        bool pending = false;
+        double open = 0, close = 0, low = 0, high = 0, volume = 0;
+        ms_t bucket = 0;
+
+    public:
+
+        // the epoch is a Thursday, week buckets are shifted to start on Monday
+        static const ms_t weekOffset = 4 * MS_PER_DAY;
+
+        static ms_t bucketStart(ms_t start, ms_t period) {
+            const ms_t offset = period % MS_PER_WEEK ? 0 : weekOffset;
+            ms_t rem = (start - offset) % period;
+            return rem < 0 ? start - rem - period : start - rem;
+        }
+
+        CandleAggregator(ms_t period, vector<Candle>& candles):
+            period(period), candles(candles)
+        {
+            if (period <= 0) throw ERROR("Invalid aggregation period: " + to_string(period));
+        }
+
+        void add(double open, double close, double low, double high, double volume, ms_t start) {
+            const ms_t at = bucketStart(start, period);
+            if (pending && at == bucket) {
+                this->close = close;
+                this->low = min(this->low, low);
+                this->high = max(this->high, high);
+                this->volume += volume;
+                return;
+            }
+            flush();
+            pending = true;
+            bucket = at;
+            this->open = open;
+            this->close = close;
+            this->low = low;
+            this->high = high;
+            this->volume = volume;
+        }
+
+        void add(const Candle& candle) {
+            add(
+                candle.getOpen(), candle.getClose(), candle.getLow(), candle.getHigh(),
+                candle.getVolume(), candle.getStart()
+            );
+        }
+
+        void flush() {
+            if (!pending) return;
+            candles.push_back(Candle(open, close, low, high, volume, bucket, bucket + period - 1));
+            pending = false;
+        }
+    };
+
+    // aggregates the [from, to) rows of a store in one pass over its columns
+    inline void candles_aggregate(
+        CandleStore& store, ms_t period, vector<Candle>& candles,
+        size_t from = 0, size_t to = SIZE_MAX
+    ) {
+        if (period < store.getPeriod())
+            throw ERROR("Can not aggregate " + to_string(store.getPeriod()) + "ms candles into " + to_string(period) + "ms");
+        if (to > store.size()) to = store.size();
+        if (from >= to) return;
+        vector<ms_t> starts;
+        store.getTimes(&starts, nullptr);
+        const double* opens = store.getOpens();
+        const double* closes = store.getCloses();
+        const double* lows = store.getLows();
+        const double* highs = store.getHighs();
+        const double* volumes = store.getVolumes();
+        candles.reserve(candles.size() + (size_t)((starts[to - 1] - starts[from]) / period) + 1);
+        CandleAggregator aggregator(period, candles);
+        for (size_t i = from; i < to; i++)
+            aggregator.add(opens[i], closes[i], lows[i], highs[i], volumes[i], starts[i]);
+        aggregator.flush();
+    }
+
+    inline void candles_aggregate(const vector<Candle>& source, ms_t period, vector<Candle>& candles) {
+        CandleAggregator aggregator(period, candles);
+        for (const Candle& candle: source) aggregator.add(candle);
+        aggregator.flush();
+    }
+
+    /**
+     * Joins the neighbour candles of the same start, e.g. the partial
+     * buckets at the end and the beginning of separately aggregated years.
+     */
+    inline void candles_merge_adjacent(vector<Candle>& candles) {
+        if (candles.empty()) return;
+        size_t last = 0;
+        for (size_t i = 1; i < candles.size(); i++) {
+            Candle& prev = candles[last];
+            const Candle& next = candles[i];
+            if (next.getStart() != prev.getStart()) {
+                candles[++last] = next;
+                continue;
+            }
+            prev.setClose(next.getClose());
+            prev.setLow(min(prev.getLow(), next.getLow()));
+            prev.setHigh(max(prev.getHigh(), next.getHigh()));
+            prev.setVolume(prev.getVolume() + next.getVolume());
+            prev.setEnd(max(prev.getEnd(), next.getEnd()));
+        }
+        candles.resize(last + 1);
+    }
+
+}
\ No newline at end of file
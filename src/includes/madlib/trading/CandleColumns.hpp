@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+
+#include "Candle.hpp"
+
+using namespace std;
+
+namespace madlib::trading {
+
+    /**
+     * Structure-of-arrays candles, every field is a contiguous array
+     * so a loop over one field (e.g. the closes) streams only that field.
+     */
+    class CandleColumns {
+    protected:
+        vector<double> opens;
+        vector<double> closes;
+        vector<double> lows;
+        vector<double> highs;
+        vector<double> volumes;
+        vector<ms_t> starts;
+        vector<ms_t> ends;
+
+    public:
+
+        CandleColumns() {}
+
+        explicit CandleColumns(const vector<Candle>& candles) {
+            assign(candles);
+        }
+
+        virtual ~CandleColumns() {}
+
+        void assign(const vector<Candle>& candles) {
+            clear();
+            reserve(candles.size());
+            for (const Candle& candle: candles) push_back(candle);
+        }
+
+        void reserve(size_t size) {
+            opens.reserve(size);
+            closes.reserve(size);
+            lows.reserve(size);
+            highs.reserve(size);
+            volumes.reserve(size);
+            starts.reserve(size);
+            ends.reserve(size);
+        }
+
+        void clear() {
+            opens.clear();
+            closes.clear();
+            lows.clear();
+            highs.clear();
+            volumes.clear();
+            starts.clear();
+            ends.clear();
+        }
+
+        void push_back(const Candle& candle) {
+            opens.push_back(candle.getOpen());
+            closes.push_back(candle.getClose());
+            lows.push_back(candle.getLow());
+            highs.push_back(candle.getHigh());
+            volumes.push_back(candle.getVolume());
+            starts.push_back(candle.getStart());
+            ends.push_back(candle.getEnd());
+        }
+
+        size_t size() const {
+            return closes.size();
+        }
+
+        bool empty() const {
+            return closes.empty();
+        }
+
+        Candle at(size_t i) const {
+            return Candle(opens[i], closes[i], lows[i], highs[i], volumes[i], starts[i], ends[i]);
+        }
+
+        const vector<double>& getOpens() const {
+            return opens;
+        }
+
+        const vector<double>& getCloses() const {
+            return closes;
+        }
+
+        const vector<double>& getLows() const {
+            return lows;
+        }
+
+        const vector<double>& getHighs() const {
+            return highs;
+        }
+
+        const vector<double>& getVolumes() const {
+            return volumes;
+        }
+
+        const vector<ms_t>& getStarts() const {
+            return starts;
+        }
+
+        const vector<ms_t>& getEnds() const {
+            return ends;
+        }
+    };
+
+}
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <mutex>
+
 #include "Candle.hpp"
+#include "CandleColumns.hpp"
 #include "Trade.hpp"
 #include "History.hpp"
 
@@ -10,6 +13,18 @@ namespace madlib::trading {
     protected:
         vector<Candle> candles;
 
+        // built from the candles on the first use
+        mutable mutex columnsMutex;
+        mutable CandleColumns columns;
+        mutable bool columnsValid = false;
+        mutable const Candle* columnsBuiltFrom = nullptr;
+
+        // call it after the candles are changed
+        void invalidateCandleColumns() {
+            lock_guard<mutex> lock(columnsMutex);
+            columnsValid = false;
+        }
+
     public:
         using History::History; // TODO: bug: some history having overlaping period that may runs multiple times in tests
 
@@ -22,6 +37,26 @@ namespace madlib::trading {
         virtual const vector<Candle>& getCandles() const {
             return candles;
         }
+
+        /**
+         * The same candles as getCandles() in columns.
+         * @note built lazily under a lock, so concurrent readers (e.g. the
+         * sweep workers) get the same columns built once
+         */
+        virtual const CandleColumns& getCandleColumns() const {
+            const vector<Candle>& source = getCandles();
+            lock_guard<mutex> lock(columnsMutex);
+            if (
+                !columnsValid ||
+                columns.size() != source.size() ||
+                columnsBuiltFrom != source.data()
+            ) {
+                columns.assign(source);
+                columnsBuiltFrom = source.data();
+                columnsValid = true;
+            }
+            return columns;
+        }
         
         // TODO: yagni?
         // virtual void saveCandles(const string &filename, const vector<Candle>& candles) const {
@@ -2,6 +2,7 @@
 
 #include "../graph/Chart.hpp"
 #include "CandleHistory.hpp"
+#include "TradeJournal.hpp"
 
 namespace madlib::trading {
     
@@ -18,6 +19,9 @@ namespace madlib::trading {
         PointSeries* volumeSeries = nullptr;
         LabelSeries* labelSeries = nullptr;
 
+        const TradeJournal* tradeJournal = nullptr;
+        size_t tradeJournalLabeled = 0; // journal events already turned into labels
+
     public:
 
         CandleHistoryChart(
@@ -92,20 +96,49 @@ namespace madlib::trading {
             return labelSeries;
         }
 
+        void setTradeJournal(const TradeJournal* tradeJournal) {
+            this->tradeJournal = tradeJournal;
+            tradeJournalLabeled = 0;
+        }
+
+        // labels for the journal events recorded since the last draw
+        void generateFromTradeJournal() {
+            if (!labelSeries || !tradeJournal) return;
+            const vector<TradeJournal::Event>& events = tradeJournal->getEvents();
+            if (events.size() < tradeJournalLabeled) { // journal restarted
+                labelSeries->clearShapes();
+                tradeJournalLabeled = 0;
+            }
+            for (; tradeJournalLabeled < events.size(); tradeJournalLabeled++) {
+                const TradeJournal::Event& event = events[tradeJournalLabeled];
+                if (event.status == TradeJournal::FAILED)
+                    labelSeries->addShape(createLabelShape(event.time, event.price, "ERROR", Theme::defaultTradeLabelErrorColor));
+                else if (event.side == TradeJournal::BUY)
+                    labelSeries->addShape(createLabelShape(event.time, event.price, "BUY", Theme::defaultTradeLabelBuyColor));
+                else
+                    labelSeries->addShape(createLabelShape(event.time, event.price, "SELL", Theme::defaultTradeLabelSellColor));
+            }
+        }
+
+        virtual void draw() override {
+            generateFromTradeJournal();
+            Chart::draw();
+        }
+
         void generateFromHistory() {
             
             if (candleSeries) {
                 const vector<Candle>& candles = candleHistory->getCandles();
-                vector<Shape*>& candleShapes = candleSeries->getShapes();
+                candleSeries->reserveCandles(candles.size());
                 for (const Candle& candle: candles) {
-                    candleShapes.push_back(createCandleShape(
+                    candleSeries->addCandle(
                         candle.getStart(),
                         candle.getEnd(),
                         candle.getOpen(),
                         candle.getLow(),
                         candle.getHigh(),
                         candle.getClose()
-                    ));
+                    );
                 }
             }
 
@@ -113,13 +146,11 @@ namespace madlib::trading {
                 const vector<Trade>& trades = candleHistory->getTrades();
                 if (trades.size()) {
                     mainProjector = priceSeries;
+                    if (priceSeries) priceSeries->reservePoints(trades.size());
+                    if (volumeSeries) volumeSeries->reservePoints(trades.size());
                     for (const Trade& trade: trades) {
-                        if (priceSeries) priceSeries->getShapes().push_back(
-                            createPointShape(trade.timestamp, trade.price)
-                        );
-                        if (volumeSeries) volumeSeries->getShapes().push_back(
-                            createPointShape(trade.timestamp, trade.volume)
-                        );
+                        if (priceSeries) priceSeries->addPoint(trade.timestamp, trade.price);
+                        if (volumeSeries) volumeSeries->addPoint(trade.timestamp, trade.volume);
                     }
                 }
             }
@@ -155,6 +186,7 @@ namespace madlib::trading {
 
         virtual void clearProjectors() override {
             Chart::clearProjectors();
+            tradeJournalLabeled = 0;
             generateFromHistory();
             fitTimeRangeToHistory();
         }
@@ -0,0 +1,385 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <string_view>
+#include <vector>
+#include <string>
+
+#include "../../../../libs/clib/clib/time.hpp"
+#include "../../../../libs/clib/clib/err.hpp"
+
+#include "../MappedFile.hpp"
+#include "Candle.hpp"
+
+using namespace std;
+using namespace clib;
+
+namespace madlib::trading {
+
+    /**
+     * Versioned, columnar binary candle file.
+     *
+     * Layout: [header][open][close][low][high][volume][start][end]
+     * Price and volume columns are raw double arrays (8 byte aligned so
+     * they can be used straight from the mapped file), start times are
+     * zigzag varint deltas from the previous start and end times are
+     * zigzag varint offsets from their own start.
+     * Every column has its own checksum, so a reader only has to verify
+     * (and touch) the columns it actually uses.
+     * An aggregated store also records the row count and last start of
+     * the store it was made from, so a cache can tell when it is stale.
+     * Version 1 files (without the source fields) are still readable.
+     */
+    class CandleStore {
+    public:
+
+        enum Column { OPEN = 0, CLOSE, LOW, HIGH, VOLUME, START, END, COLUMNS };
+
+        enum ColumnMask {
+            MASK_OPEN = 1 << OPEN,
+            MASK_CLOSE = 1 << CLOSE,
+            MASK_LOW = 1 << LOW,
+            MASK_HIGH = 1 << HIGH,
+            MASK_VOLUME = 1 << VOLUME,
+            MASK_START = 1 << START,
+            MASK_END = 1 << END,
+            MASK_TIMES = MASK_START | MASK_END,
+            MASK_ALL = (1 << COLUMNS) - 1,
+        };
+
+        static constexpr const char magic[4] = { 'M', 'C', 'S', 'T' };
+        static const uint32_t version = 2;
+        static const size_t symbolSize = 16;
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            char symbol[symbolSize];
+            int64_t period;
+            uint64_t count;
+            int64_t firstStart;
+            int64_t lastStart;
+            uint64_t columnOffsets[COLUMNS];
+            uint64_t columnBytes[COLUMNS];
+            uint64_t columnChecksums[COLUMNS];
+            uint64_t sourceCount; // since version 2
+            int64_t sourceLastStart; // since version 2
+        };
+
+        static size_t headerSize(uint32_t version) {
+            return version < 2 ? offsetof(Header, sourceCount) : sizeof(Header);
+        }
+
+    protected:
+
+        string filename;
+        MappedFile<char> mapped;
+        Header header = {};
+        int verified = 0;
+
+        static const uint64_t checksumSeed = 14695981039346656037ULL;
+
+        // FNV-1a 64, continues from the seed so a column can be extended
+        static uint64_t checksum(const char* data, size_t size, uint64_t seed = checksumSeed) {
+            uint64_t hash = seed;
+            for (size_t i = 0; i < size; i++) {
+                hash ^= (unsigned char)data[i];
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        static void writeVarint(string& out, int64_t value) {
+            uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+            while (zigzag >= 0x80) {
+                out.push_back((char)(zigzag | 0x80));
+                zigzag >>= 7;
+            }
+            out.push_back((char)zigzag);
+        }
+
+        static int64_t readVarint(const char*& p, const char* end) {
+            uint64_t zigzag = 0;
+            int shift = 0;
+            while (p < end) {
+                unsigned char byte = (unsigned char)*p++;
+                zigzag |= (uint64_t)(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+                shift += 7;
+            }
+            throw ERROR("Truncated varint in candle store");
+        }
+
+        const char* column(Column col) const {
+            return mapped.begin() + header.columnOffsets[col];
+        }
+
+        void verify(int mask) {
+            int todo = mask & ~verified;
+            for (int col = 0; col < COLUMNS; col++) {
+                if (!(todo & (1 << col))) continue;
+                if (checksum(column((Column)col), header.columnBytes[col]) != header.columnChecksums[col])
+                    throw ERROR("Candle store checksum mismatch at column " + to_string(col));
+                verified |= 1 << col;
+            }
+        }
+
+        const double* doubles(Column col) {
+            verify(1 << col);
+            return (const double*)column(col);
+        }
+
+        static void encode(string (&columns)[COLUMNS], const vector<Candle>& candles, ms_t prev) {
+            const size_t count = candles.size();
+            vector<double> values(count);
+            for (int col = OPEN; col <= VOLUME; col++) {
+                for (size_t i = 0; i < count; i++) {
+                    const Candle& candle = candles[i];
+                    switch (col) {
+                        case OPEN: values[i] = candle.getOpen(); break;
+                        case CLOSE: values[i] = candle.getClose(); break;
+                        case LOW: values[i] = candle.getLow(); break;
+                        case HIGH: values[i] = candle.getHigh(); break;
+                        default: values[i] = candle.getVolume(); break;
+                    }
+                }
+                columns[col].assign((const char*)values.data(), count * sizeof(double));
+            }
+            for (const Candle& candle: candles) {
+                writeVarint(columns[START], candle.getStart() - prev);
+                writeVarint(columns[END], candle.getEnd() - candle.getStart());
+                prev = candle.getStart();
+            }
+        }
+
+        // every column is written as its existing prefix followed by the new bytes,
+        // into a temp file renamed over the target so readers never see a partial file
+        static void write(
+            const string& filename, Header& header, const vector<Candle>& candles,
+            const string_view (&prefixes)[COLUMNS], const string (&columns)[COLUMNS],
+            const uint64_t (&seeds)[COLUMNS]
+        ) {
+            if (!candles.empty()) {
+                if (!header.count) header.firstStart = (int64_t)candles.front().getStart();
+                header.lastStart = (int64_t)candles.back().getStart();
+            }
+            header.version = version;
+            header.count += (uint64_t)candles.size();
+            uint64_t offset = sizeof(Header);
+            for (int col = 0; col < COLUMNS; col++) {
+                header.columnOffsets[col] = offset;
+                header.columnBytes[col] = prefixes[col].size() + columns[col].size();
+                header.columnChecksums[col] = checksum(columns[col].data(), columns[col].size(), seeds[col]);
+                offset += header.columnBytes[col];
+            }
+
+            const string tmpFile = filename + ".tmp";
+            ofstream file(tmpFile, ios::binary | ios::trunc);
+            if (!file.is_open()) throw ERROR("Error opening file for writing: " + tmpFile);
+            file.write((const char*)&header, sizeof(header));
+            for (int col = 0; col < COLUMNS; col++) {
+                file.write(prefixes[col].data(), (streamsize)prefixes[col].size());
+                file.write(columns[col].data(), (streamsize)columns[col].size());
+            }
+            if (!file.good()) throw ERROR("Error writing file: " + tmpFile);
+            file.close();
+            if (rename(tmpFile.c_str(), filename.c_str()))
+                throw ERROR("Error replacing file: " + filename);
+        }
+
+    public:
+
+        CandleStore() {}
+
+        explicit CandleStore(const string& filename) {
+            open(filename);
+        }
+
+        virtual ~CandleStore() {}
+
+        void open(const string& filename) {
+            this->filename = filename;
+            mapped.map(filename);
+            verified = 0;
+            memset(&header, 0, sizeof(header));
+            if (mapped.size() < headerSize(1))
+                throw ERROR("Not a candle store (too short): " + filename);
+            Header h;
+            memset(&h, 0, sizeof(h));
+            memcpy(&h, mapped.begin(), headerSize(1));
+            if (memcmp(h.magic, magic, sizeof(magic)))
+                throw ERROR("Not a candle store (bad magic): " + filename);
+            if (h.version < 1 || h.version > version)
+                throw ERROR("Unsupported candle store version " + to_string(h.version) + ": " + filename);
+            if (mapped.size() < headerSize(h.version))
+                throw ERROR("Truncated candle store: " + filename);
+            memcpy(&h, mapped.begin(), headerSize(h.version));
+            // written so nothing wraps around, the double columns are used
+            // straight from the mapping for count rows
+            const uint64_t size = mapped.size();
+            for (int col = 0; col < COLUMNS; col++) {
+                const uint64_t offset = h.columnOffsets[col];
+                const uint64_t bytes = h.columnBytes[col];
+                if (offset > size || bytes > size - offset)
+                    throw ERROR("Truncated candle store: " + filename);
+                if (col <= VOLUME && (
+                    offset % sizeof(double) || bytes % sizeof(double) || 
+                    bytes / sizeof(double) != h.count
+                )) throw ERROR("Broken candle store header: " + filename);
+            }
+            header = h;
+        }
+
+        // the header and the checksums of every column
+        static bool isValid(const string& filename) {
+            try {
+                CandleStore store(filename);
+                store.verify(MASK_ALL);
+                return true;
+            } catch (exception&) {
+                return false;
+            }
+        }
+
+        const Header& getHeader() const {
+            return header;
+        }
+
+        string getSymbol() const {
+            return string(header.symbol, strnlen(header.symbol, symbolSize));
+        }
+
+        ms_t getPeriod() const {
+            return (ms_t)header.period;
+        }
+
+        size_t size() const {
+            return (size_t)header.count;
+        }
+
+        ms_t getFirstStart() const {
+            return (ms_t)header.firstStart;
+        }
+
+        ms_t getLastStart() const {
+            return (ms_t)header.lastStart;
+        }
+
+        // rows of the source store when this one is an aggregate of it, 0 otherwise
+        size_t getSourceCount() const {
+            return (size_t)header.sourceCount;
+        }
+
+        ms_t getSourceLastStart() const {
+            return (ms_t)header.sourceLastStart;
+        }
+
+        const double* getOpens() { return doubles(OPEN); }
+        const double* getCloses() { return doubles(CLOSE); }
+        const double* getLows() { return doubles(LOW); }
+        const double* getHighs() { return doubles(HIGH); }
+        const double* getVolumes() { return doubles(VOLUME); }
+
+        void getTimes(vector<ms_t>* starts, vector<ms_t>* ends) {
+            verify(MASK_START | (ends ? MASK_END : 0));
+            const size_t count = size();
+            vector<ms_t> _starts;
+            vector<ms_t>& s = starts ? *starts : _starts;
+            s.resize(count);
+            const char* p = column(START);
+            const char* e = p + header.columnBytes[START];
+            ms_t prev = 0;
+            for (size_t i = 0; i < count; i++) s[i] = prev = prev + readVarint(p, e);
+            if (!ends) return;
+            ends->resize(count);
+            p = column(END);
+            e = p + header.columnBytes[END];
+            for (size_t i = 0; i < count; i++) (*ends)[i] = s[i] + readVarint(p, e);
+        }
+
+        void getCandles(vector<Candle>& candles, size_t from = 0, size_t to = SIZE_MAX) {
+            vector<ms_t> starts, ends;
+            getTimes(&starts, &ends);
+            getCandles(candles, starts, ends, from, to);
+        }
+
+        void getCandles(
+            vector<Candle>& candles,
+            const vector<ms_t>& starts, const vector<ms_t>& ends,
+            size_t from = 0, size_t to = SIZE_MAX
+        ) {
+            if (to > size()) to = size();
+            if (from >= to) return;
+            const double* opens = getOpens();
+            const double* closes = getCloses();
+            const double* lows = getLows();
+            const double* highs = getHighs();
+            const double* volumes = getVolumes();
+            candles.reserve(candles.size() + (to - from));
+            for (size_t i = from; i < to; i++)
+                candles.push_back(Candle(
+                    opens[i], closes[i], lows[i], highs[i], volumes[i],
+                    starts[i], ends[i]
+                ));
+        }
+
+        static void save(
+            const string& filename, const string& symbol, ms_t period,
+            const vector<Candle>& candles, const CandleStore* source = nullptr
+        ) {
+            Header header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, magic, sizeof(magic));
+            strncpy(header.symbol, symbol.c_str(), symbolSize);
+            header.period = (int64_t)period;
+            if (source) {
+                header.sourceCount = (uint64_t)source->size();
+                header.sourceLastStart = (int64_t)source->getLastStart();
+            }
+
+            string columns[COLUMNS];
+            encode(columns, candles, 0);
+            string_view prefixes[COLUMNS];
+            uint64_t seeds[COLUMNS];
+            for (int col = 0; col < COLUMNS; col++) seeds[col] = checksumSeed;
+            write(filename, header, candles, prefixes, columns, seeds);
+        }
+
+        /**
+         * Adds newer candles to the end of the opened store, the
+         * existing columns are copied as they are and only the new
+         * rows are encoded and checksummed, then the store is
+         * reopened on the new file.
+         */
+        void append(const vector<Candle>& candles) {
+            if (candles.empty()) return;
+            if (size() && candles.front().getStart() <= getLastStart())
+                throw ERROR("Candles to append are not newer than the candle store: " + filename);
+
+            Header h = header;
+            string columns[COLUMNS];
+            encode(columns, candles, size() ? getLastStart() : 0);
+            string_view prefixes[COLUMNS];
+            uint64_t seeds[COLUMNS];
+            for (int col = 0; col < COLUMNS; col++) {
+                prefixes[col] = string_view(column((Column)col), header.columnBytes[col]);
+                seeds[col] = header.columnChecksums[col];
+            }
+            const string file = filename;
+            write(file, h, candles, prefixes, columns, seeds);
+            open(file);
+        }
+
+        static vector<Candle> load(const string& filename) {
+            vector<Candle> candles;
+            CandleStore store(filename);
+            store.getCandles(candles);
+            return candles;
+        }
+    };
+
+}
\ No newline at end of file
@@ -1,16 +1,29 @@
 #pragma once
 
 #include "Candle.hpp"
+#include "CandleColumns.hpp"
 #include "Strategy.hpp"
 
 namespace madlib::trading {
     
     class CandleStrategy: public Strategy {
+    protected:
+
+        // index of the current candle in the history columns
+        size_t candleIndex = 0;
+
     public:
         
         using Strategy::Strategy;
 
         virtual ~CandleStrategy() {}
+
+        // called once before onStart, indicators can be precomputed here over the whole history
+        virtual void onCandleHistory(const CandleColumns&) {}
+
+        void setCandleIndex(size_t candleIndex) {
+            this->candleIndex = candleIndex;
+        }
     };
 
 
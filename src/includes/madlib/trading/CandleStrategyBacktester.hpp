@@ -68,16 +68,23 @@ namespace madlib::trading {
             if (onProgressStart && !onProgressStart(progressContext)) return false;
 
             const vector<Candle>& candles = candleHistory->getCandles();
-            Pair& pair = testExchange->getPairAt(symbol);
+            const pair_id_t pairId = testExchange->getPairId(symbol);
+            Pair& pair = testExchange->getPairAt(pairId);
             
+            candleStrategy->getTradeJournal().clear();
+            candleStrategy->onCandleHistory(candleHistory->getCandleColumns());
             candleStrategy->onStart((Exchange*&)testExchange, symbol);
 
             bool first = true;
-            for (const Candle& candle: candles) {
+            for (size_t i = 0; i < candles.size(); i++) {
+                const Candle& candle = candles[i];
                 progressContext.candle = &candle;
+                candleStrategy->setCandleIndex(i);
 
                 testExchange->setCurrentTime(candle.getEnd());
                 pair.setPrice(candle.getClose()); // TODO: set the price to a later price (perhaps next open price) so that, we can emulate some exchange communication latency
+                // orders resting from the previous candles
+                testExchange->matchOrders(pairId, candle.getLow(), candle.getHigh());
 
                 if (onProgressStep && !onProgressStep(progressContext)) 
                     return false;
@@ -90,6 +97,8 @@ namespace madlib::trading {
                 candleStrategy->onCandleClose((Exchange*&)testExchange, symbol, candle);
             }
 
+            candleStrategy->onFinish((Exchange*&)testExchange, symbol);
+
             if (onProgressFinish) return onProgressFinish(progressContext);
 
             return true;
@@ -49,12 +49,23 @@ namespace madlib::trading {
             ms_t progressUpdatedAt = 0;
             Progress* progress = nullptr;
 
-            // show results on charts:
-            vector<Shape*>* balanceQuotedAtCloses = nullptr;
-            vector<Shape*>* balanceQuotedFullAtCloses = nullptr;
-            vector<Shape*>* balanceBaseAtCloses = nullptr;
-            vector<Shape*>* balanceBaseFullAtCloses = nullptr;
-            Pair* pair = nullptr;
+            // show results on charts, one value per candle:
+            TimeSeries balanceQuotedAtCloses;
+            TimeSeries balanceQuotedFullAtCloses;
+            TimeSeries balanceBaseAtCloses;
+            TimeSeries balanceBaseFullAtCloses;
+            pair_id_t pairId = 0; // resolved once, see onProgressStart()
+
+            void resetBalances(const vector<ms_t>* closeTimes) {
+                for (TimeSeries* timeSeries: {
+                    &balanceQuotedAtCloses, &balanceQuotedFullAtCloses,
+                    &balanceBaseAtCloses, &balanceBaseFullAtCloses
+                }) {
+                    timeSeries->setTimes(closeTimes);
+                    timeSeries->clear();
+                    timeSeries->reserve(closeTimes->size());
+                }
+            }
 
             bool showProgressStarted = false;
 
@@ -72,14 +83,9 @@ namespace madlib::trading {
                 (CandleStrategyBacktesterMultiChartAccordion*)progressContext.callerContext;
 
             that->clearCharts();
-            that->progressState.balanceQuotedAtCloses = 
-                &that->balanceQuotedScale->getShapes();
-            that->progressState.balanceQuotedFullAtCloses = 
-                &that->balanceQuotedFullScale->getShapes();
-            that->progressState.balanceBaseAtCloses = 
-                &that->balanceBaseScale->getShapes();
-            that->progressState.balanceBaseFullAtCloses = 
-                &that->balanceBaseFullScale->getShapes();
+            that->progressState.resetBalances(
+                &that->candleHistory->getCandleColumns().getEnds()
+            );
 
             if (that->showProgress || that->logProgress) {
                 that->progressState.candlesSize = 
@@ -93,7 +99,7 @@ namespace madlib::trading {
                     that->progressState.showProgressStarted = false;
             }
 
-            that->progressState.pair = &that->testExchange->getPairAt(that->symbol);
+            that->progressState.pairId = that->testExchange->getPairId(that->symbol);
 
             return true;
         }
@@ -130,34 +136,28 @@ namespace madlib::trading {
             
             // collect data to charts
 
-            ms_t currentTime = progressContext.candle->getEnd();
-            Pair* pair = that->progressState.pair;
+            const pair_id_t pairId = that->progressState.pairId;
 
             // **** balanceQuotedChart ****
 
-            if (that->showBalanceQuotedScale) {
-                that->progressState.balanceQuotedAtCloses->push_back(that->balanceQuotedChart->createPointShape(
-                    currentTime,
-                    that->testExchange->getBalanceQuoted(*pair)
-                ));
-            }
+            if (that->showBalanceQuotedScale)
+                that->progressState.balanceQuotedAtCloses.push_back(
+                    that->testExchange->getBalanceQuoted(pairId)
+                );
             
-            that->progressState.balanceQuotedFullAtCloses->push_back(that->balanceQuotedChart->createPointShape(
-                currentTime,
-                that->testExchange->getBalanceQuotedFull(*pair)
-            ));
+            that->progressState.balanceQuotedFullAtCloses.push_back(
+                that->testExchange->getBalanceQuotedFull(pairId)
+            );
 
             // **** balanceBaseChart ****
         
-            that->progressState.balanceBaseAtCloses->push_back(that->balanceBaseChart->createPointShape(
-                currentTime,
-                that->testExchange->getBalanceBase(*pair)
-            ));
+            that->progressState.balanceBaseAtCloses.push_back(
+                that->testExchange->getBalanceBase(pairId)
+            );
             
-            that->progressState.balanceBaseFullAtCloses->push_back(that->balanceBaseChart->createPointShape(
-                currentTime,
-                that->testExchange->getBalanceBaseFull(*pair)
-            ));
+            that->progressState.balanceBaseFullAtCloses.push_back(
+                that->testExchange->getBalanceBaseFull(pairId)
+            );
 
             return true;
         }
@@ -239,6 +239,8 @@ namespace madlib::trading {
             );
             balanceQuotedFullScale = balanceQuotedChart->createPointSeries(nullptr, lightGreen);
             balanceQuotedScale = balanceQuotedChart->createPointSeries(balanceQuotedFullScale, green);
+            balanceQuotedFullScale->setTimeSeries(&progressState.balanceQuotedFullAtCloses);
+            balanceQuotedScale->setTimeSeries(&progressState.balanceQuotedAtCloses);
 
             candleStrategy->setBalanceQuotedChart(balanceQuotedChart);
 
@@ -249,6 +251,8 @@ namespace madlib::trading {
             );
             balanceBaseFullScale = balanceBaseChart->createPointSeries(nullptr, yellow);
             balanceBaseScale = balanceBaseChart->createPointSeries(balanceBaseFullScale, orange);
+            balanceBaseFullScale->setTimeSeries(&progressState.balanceBaseFullAtCloses);
+            balanceBaseScale->setTimeSeries(&progressState.balanceBaseAtCloses);
 
             candleStrategy->setBalanceBaseChart(balanceBaseChart);
 
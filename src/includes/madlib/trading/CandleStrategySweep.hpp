@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "CandleHistory.hpp"
+#include "TestExchange.hpp"
+#include "CandleStrategy.hpp"
+#include "CandleStrategyBacktester.hpp"
+
+namespace madlib::trading {
+
+    /**
+     * Headless parameter sweep, runs one backtest per parameter set on
+     * a thread pool. Every run gets its own copy of the exchange and a
+     * new strategy, the candles are shared read-only.
+     */
+    class CandleStrategySweep {
+    public:
+
+        typedef CandleStrategy* (*StrategyCreator)();
+
+        struct Axis {
+            string name;
+            vector<double> values; // grid values
+            double min = 0; // random search range (used when no values)
+            double max = 0;
+        };
+
+        struct Result {
+            vector<double> parameters; // in the order of the axes
+            double balanceQuotedFullStart = 0;
+            double balanceQuotedFull = 0;
+            double profitPc = 0;
+            double maxDrawdownPc = 0;
+            string error;
+        };
+
+    protected:
+
+        struct RunContext {
+            TestExchange* testExchange = nullptr;
+            pair_id_t pairId = 0;
+            double start = 0;
+            double peak = 0;
+            double maxDrawdownPc = 0;
+        };
+
+        static bool onProgressStep(CandleStrategyBacktester::ProgressContext& progressContext) {
+            RunContext* context = (RunContext*)progressContext.callerContext;
+            const double balance = context->testExchange->getBalanceQuotedFull(context->pairId);
+            if (!context->start) context->start = balance;
+            if (balance > context->peak) context->peak = balance;
+            if (context->peak > 0) {
+                const double drawdownPc = (context->peak - balance) / context->peak * 100;
+                if (drawdownPc > context->maxDrawdownPc) context->maxDrawdownPc = drawdownPc;
+            }
+            return true;
+        }
+
+        CandleHistory* candleHistory;
+        const TestExchange& testExchange;
+        StrategyCreator createStrategy;
+        const string symbol;
+        vector<Axis> axes;
+
+        void runAt(const vector<double>& parameters, Result& result) const {
+            result.parameters = parameters;
+            TestExchange exchange(testExchange);
+            CandleStrategy* strategy = nullptr;
+            try {
+                strategy = createStrategy();
+                for (size_t i = 0; i < axes.size(); i++)
+                    strategy->setParameter(axes[i].name, parameters.at(i));
+                backtest(candleHistory, exchange, strategy, symbol, result);
+            } catch (exception& e) {
+                result.error = e.what();
+            }
+            delete strategy;
+        }
+
+    public:
+
+        CandleStrategySweep(
+            CandleHistory* candleHistory,
+            const TestExchange& testExchange,
+            StrategyCreator createStrategy,
+            const string& symbol
+        ):
+            candleHistory(candleHistory),
+            testExchange(testExchange),
+            createStrategy(createStrategy),
+            symbol(symbol)
+        {}
+
+        virtual ~CandleStrategySweep() {}
+
+        // one headless backtest, the metrics are written into the result
+        static void backtest(
+            CandleHistory* candleHistory, TestExchange& testExchange,
+            CandleStrategy* candleStrategy, const string& symbol, Result& result
+        ) {
+            TestExchange* exchangePtr = &testExchange;
+            RunContext context;
+            context.testExchange = exchangePtr;
+            context.pairId = testExchange.getPairId(symbol);
+            CandleStrategyBacktester backtester(
+                &context, candleHistory, exchangePtr, candleStrategy, symbol,
+                nullptr, onProgressStep, nullptr
+            );
+            backtester.backtest();
+
+            result.balanceQuotedFullStart = context.start;
+            result.balanceQuotedFull = testExchange.getBalanceQuotedFull(context.pairId);
+            result.profitPc = context.start
+                ? (result.balanceQuotedFull - context.start) / context.start * 100
+                : 0;
+            result.maxDrawdownPc = context.maxDrawdownPc;
+        }
+
+        const vector<Axis>& getAxes() const {
+            return axes;
+        }
+
+        void addValues(const string& name, const vector<double>& values) {
+            if (values.empty()) throw ERROR("No values for sweep parameter: " + name);
+            axes.push_back({ name, values, 0, 0 });
+        }
+
+        void addGrid(const string& name, double from, double to, double step) {
+            if (step <= 0 || to < from) throw ERROR("Invalid sweep grid for parameter: " + name);
+            vector<double> values;
+            for (size_t i = 0; from + step * (double)i <= to + step * 1e-9; i++)
+                values.push_back(from + step * (double)i);
+            addValues(name, values);
+        }
+
+        void addRange(const string& name, double min, double max) {
+            if (max < min) throw ERROR("Invalid sweep range for parameter: " + name);
+            axes.push_back({ name, {}, min, max });
+        }
+
+        // every combination of the axis values
+        vector<vector<double>> getGridPoints() const {
+            vector<vector<double>> points(1);
+            for (const Axis& axis: axes) {
+                if (axis.values.empty()) throw ERROR("Sweep parameter has no grid values: " + axis.name);
+                vector<vector<double>> next;
+                next.reserve(points.size() * axis.values.size());
+                for (const vector<double>& point: points)
+                    for (double value: axis.values) {
+                        next.push_back(point);
+                        next.back().push_back(value);
+                    }
+                points = move(next);
+            }
+            return points;
+        }
+
+        // uniform samples of the ranges (or of the values when an axis has values),
+        // from an own generator so the global rand_gen is left alone
+        vector<vector<double>> getRandomPoints(size_t count, unsigned int seed) const {
+            mt19937 gen(seed);
+            vector<vector<double>> points(count);
+            for (vector<double>& point: points)
+                for (const Axis& axis: axes) {
+                    if (axis.values.empty()) {
+                        uniform_real_distribution<double> dis(axis.min, axis.max);
+                        point.push_back(dis(gen));
+                        continue;
+                    }
+                    uniform_int_distribution<size_t> dis(0, axis.values.size() - 1);
+                    point.push_back(axis.values[dis(gen)]);
+                }
+            return points;
+        }
+
+        vector<Result> run(const vector<vector<double>>& points, size_t threads = 0) const {
+            if (!threads) threads = thread::hardware_concurrency();
+            if (!threads) threads = 1;
+            if (threads > points.size()) threads = points.size();
+
+            // shared state is built before the workers start reading it
+            candleHistory->getCandleColumns();
+
+            vector<Result> results(points.size());
+            atomic<size_t> next(0);
+            auto worker = [&]() {
+                for (size_t i = next++; i < points.size(); i = next++)
+                    runAt(points[i], results[i]);
+            };
+            vector<thread> workers;
+            for (size_t i = 0; i < threads; i++) workers.emplace_back(worker);
+            for (thread& t: workers) t.join();
+            return results;
+        }
+    };
+
+}
\ No newline at end of file
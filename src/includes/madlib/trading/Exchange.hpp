@@ -2,6 +2,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "../../../../libs/clib/clib/time.hpp"
 
@@ -12,16 +13,97 @@ using namespace clib;
 
 namespace madlib::trading {
     
+    // interned symbols and currencies, see Exchange::getPairId()
+    typedef size_t pair_id_t;
+    typedef size_t currency_id_t;
+    typedef size_t order_id_t; // 0 is no order
+
     class Exchange {
+    public:
+
+        // result of the execute...() order calls, these never throw
+        enum OrderStatus: unsigned char { 
+            ORDER_FILLED, 
+            ORDER_OPEN, // resting on the book
+            ORDER_INVALID_AMOUNT, 
+            ORDER_INVALID_PRICE, 
+            ORDER_INSUFFICIENT_FUNDS, 
+            ORDER_UNSUPPORTED,
+        };
+
+        enum OrderSide: unsigned char { BUY, SELL };
+
+        enum OrderType: unsigned char { LIMIT, STOP_LOSS, TAKE_PROFIT };
+
+        // a resting order that was reached by the price
+        struct Fill {
+            order_id_t orderId;
+            pair_id_t pairId;
+            OrderSide side;
+            OrderType type;
+            ms_t time;
+            double price;
+            double amount;
+            double fee; // in the received currency
+        };
+
+        static const char* getOrderStatusName(OrderStatus status) {
+            switch (status) {
+                case ORDER_FILLED: return "filled";
+                case ORDER_OPEN: return "open";
+                case ORDER_INVALID_AMOUNT: return "invalid amount";
+                case ORDER_INVALID_PRICE: return "invalid price";
+                case ORDER_INSUFFICIENT_FUNDS: return "insufficient funds";
+                case ORDER_UNSUPPORTED: return "unsupported";
+            }
+            return "unknown";
+        }
+
     protected:
         
         map<string, Pair> pairs;
         map<string, Balance> balances;
 
+        // dense handles into the maps above (the map elements never move),
+        // handed out once by name and used as plain indexes afterwards
+        struct PairHandle {
+            string symbol;
+            Pair* pair;
+            currency_id_t baseCurrencyId;
+            currency_id_t quotedCurrencyId;
+        };
+        vector<PairHandle> pairHandles;
+        map<string, pair_id_t> pairIds;
+        vector<string> currencies;
+        vector<Balance*> currencyBalances;
+        map<string, currency_id_t> currencyIds;
+
+        // points the handles into this exchange's own maps
+        void reintern() {
+            for (PairHandle& pairHandle: pairHandles) 
+                pairHandle.pair = &pairs.at(pairHandle.symbol);
+            for (size_t i = 0; i < currencies.size(); i++)
+                currencyBalances[i] = &balances.at(currencies[i]);
+        }
+
     public:
 
         Exchange() {}
 
+        Exchange(const Exchange& other): 
+            pairs(other.pairs), 
+            balances(other.balances),
+            pairHandles(other.pairHandles),
+            pairIds(other.pairIds),
+            currencies(other.currencies),
+            currencyBalances(other.currencyBalances),
+            currencyIds(other.currencyIds)
+        {
+            reintern();
+        }
+
+        Exchange& operator=(const Exchange&) = delete;
+
         virtual ~Exchange() {}
 
         virtual vector<string> getPeriods() const {
@@ -37,38 +119,102 @@ namespace madlib::trading {
             throw ERROR("No symbol: " + symbol);
         }
 
+        // resolve once (e.g. in Strategy::onStart()), the id stays valid for the life of the exchange
+        pair_id_t getPairId(const string& symbol) {
+            auto it = pairIds.find(symbol);
+            if (it != pairIds.end()) return it->second;
+            Pair& pair = getPairAt(symbol);
+            pairHandles.push_back({ 
+                symbol, &pair, 
+                getCurrencyId(pair.getBaseCurrency()), 
+                getCurrencyId(pair.getQuotedCurrency()) 
+            });
+            return pairIds[symbol] = pairHandles.size() - 1;
+        }
+
+        currency_id_t getCurrencyId(const string& currency) {
+            auto it = currencyIds.find(currency);
+            if (it != currencyIds.end()) return it->second;
+            if (balances.count(currency) != 1) throw ERROR("No balance: " + currency);
+            currencies.push_back(currency);
+            currencyBalances.push_back(&balances.at(currency));
+            return currencyIds[currency] = currencies.size() - 1;
+        }
+
+        Pair& getPairAt(pair_id_t pairId) {
+            return *pairHandles[pairId].pair;
+        }
+
+        const string& getSymbol(pair_id_t pairId) const {
+            return pairHandles[pairId].symbol;
+        }
+
+        currency_id_t getBaseCurrencyId(pair_id_t pairId) const {
+            return pairHandles[pairId].baseCurrencyId;
+        }
+
+        currency_id_t getQuotedCurrencyId(pair_id_t pairId) const {
+            return pairHandles[pairId].quotedCurrencyId;
+        }
+
+        Balance& getBalanceAt(currency_id_t currencyId) {
+            return *currencyBalances[currencyId];
+        }
+
+        Balance& getBaseBalanceAt(pair_id_t pairId) {
+            return *currencyBalances[pairHandles[pairId].baseCurrencyId];
+        }
+
+        Balance& getQuotedBalanceAt(pair_id_t pairId) {
+            return *currencyBalances[pairHandles[pairId].quotedCurrencyId];
+        }
+
         const map<string, Balance>& getBalances() const {
             return balances;
         }
 
+        double getBalanceBase(pair_id_t pairId) {
+            return getBaseBalanceAt(pairId).getAmount();
+        }
+
         double getBalanceBase(const string& symbol) {
-            return getBalances().at(getPairAt(symbol).getBaseCurrency()).getAmount();
+            return getBalanceBase(getPairId(symbol));
         }
 
         double getBalanceBase(const Pair& pair) {
             return getBalances().at(pair.getBaseCurrency()).getAmount();
         }
 
+        double getBalanceQuoted(pair_id_t pairId) {
+            return getQuotedBalanceAt(pairId).getAmount();
+        }
+
         double getBalanceQuoted(const string& symbol) {
-            return getBalances().at(getPairAt(symbol).getQuotedCurrency()).getAmount();
+            return getBalanceQuoted(getPairId(symbol));
         }
 
         double getBalanceQuoted(const Pair& pair) {
             return getBalances().at(pair.getQuotedCurrency()).getAmount();
         }
 
+        double getBalanceQuotedFull(pair_id_t pairId) {
+            return getBalanceQuoted(pairId) + getBalanceBase(pairId) * getPairAt(pairId).getPrice();
+        }
+
         double getBalanceQuotedFull(const string& symbol) {
-            const Pair& pair = getPairAt(symbol);
-            return getBalanceQuoted(symbol) + getBalanceBase(symbol) * pair.getPrice();
+            return getBalanceQuotedFull(getPairId(symbol));
         }
 
         double getBalanceQuotedFull(const Pair& pair) {
             return getBalanceQuoted(pair) + getBalanceBase(pair) * pair.getPrice();
         }
 
+        double getBalanceBaseFull(pair_id_t pairId) {
+            return getBalanceQuoted(pairId) / getPairAt(pairId).getPrice() + getBalanceBase(pairId);
+        }
+
         double getBalanceBaseFull(const string& symbol) {
-            const Pair& pair = getPairAt(symbol);
-            return getBalanceQuoted(symbol) / pair.getPrice() + getBalanceBase(symbol);
+            return getBalanceBaseFull(getPairId(symbol));
         }
 
         double getBalanceBaseFull(const Pair& pair) {
@@ -83,10 +229,71 @@ namespace madlib::trading {
             throw ERR_UNIMP;
         }
 
+        virtual bool marketBuy(pair_id_t pairId, double amount, bool throws = true) {
+            return marketBuy(getSymbol(pairId), amount, throws);
+        }
+
         virtual bool marketSell(const string& /*symbol*/, double /*amount*/, bool = true) {
             throw ERR_UNIMP;
         }
 
+        virtual bool marketSell(pair_id_t pairId, double amount, bool throws = true) {
+            return marketSell(getSymbol(pairId), amount, throws);
+        }
+
+        // validates the whole order first and applies it only when it can be filled
+        virtual OrderStatus executeMarketBuy(pair_id_t, double) {
+            return ORDER_UNSUPPORTED;
+        }
+
+        virtual OrderStatus executeMarketSell(pair_id_t, double) {
+            return ORDER_UNSUPPORTED;
+        }
+
+        // ORDER_OPEN and the new order's id when the order is accepted
+        virtual OrderStatus executeLimitBuy(pair_id_t, double /*amount*/, double /*limitPrice*/, order_id_t& orderId) {
+            orderId = 0;
+            return ORDER_UNSUPPORTED;
+        }
+
+        virtual OrderStatus executeLimitSell(pair_id_t, double /*amount*/, double /*limitPrice*/, order_id_t& orderId) {
+            orderId = 0;
+            return ORDER_UNSUPPORTED;
+        }
+
+        // sells: the stop is below and the take-profit above the price, buys the other way around
+        virtual OrderStatus executeStopLoss(pair_id_t, OrderSide, double /*amount*/, double /*stopPrice*/, order_id_t& orderId) {
+            orderId = 0;
+            return ORDER_UNSUPPORTED;
+        }
+
+        virtual OrderStatus executeTakeProfit(pair_id_t, OrderSide, double /*amount*/, double /*takeProfitPrice*/, order_id_t& orderId) {
+            orderId = 0;
+            return ORDER_UNSUPPORTED;
+        }
+
+        // one-cancels-the-other: a take-profit and a stop-loss, when one fills the other one is cancelled
+        virtual OrderStatus executeOco(
+            pair_id_t, OrderSide, double /*amount*/, double /*takeProfitPrice*/, double /*stopPrice*/,
+            order_id_t& takeProfitId, order_id_t& stopId
+        ) {
+            takeProfitId = stopId = 0;
+            return ORDER_UNSUPPORTED;
+        }
+
+        // false when the order is not open (anymore)
+        virtual bool cancelOrder(order_id_t) {
+            return false;
+        }
+
+        virtual bool isOrderOpen(order_id_t) const {
+            return false;
+        }
+
+        virtual bool findFill(order_id_t, Fill&) const {
+            return false;
+        }
+
         virtual void limitBuy(const string& /*symbol*/, double /*amount*/, double /*limitPrice*/) {
             throw ERR_UNIMP;
         }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+namespace madlib::trading {
+
+    /**
+     * Resting orders of one pair by price, in two flat sorted arrays.
+     * CROSS_DOWN entries are reached by a falling price (e.g. buy limits),
+     * CROSS_UP entries by a rising price (e.g. sell limits). The entry
+     * that is reached first is at the back of its array so a candle only
+     * touches the entries inside its [low, high] range.
+     * Entries at the same price are reached in the order they were added.
+     */
+    class PriceBook {
+    public:
+
+        enum Cross: unsigned char { CROSS_DOWN, CROSS_UP };
+
+        struct Entry {
+            size_t id;
+            double price;
+        };
+
+        struct Crossed {
+            Cross cross;
+            Entry entry;
+        };
+
+    protected:
+
+        vector<Entry> down; // ascending
+        vector<Entry> up; // descending
+
+        static bool ascending(const Entry& entry, double price) {
+            return entry.price < price;
+        }
+
+        static bool descending(const Entry& entry, double price) {
+            return entry.price > price;
+        }
+
+    public:
+
+        size_t size() const {
+            return down.size() + up.size();
+        }
+
+        bool empty() const {
+            return down.empty() && up.empty();
+        }
+
+        void add(Cross cross, size_t id, double price) {
+            if (cross == CROSS_DOWN)
+                down.insert(lower_bound(down.begin(), down.end(), price, ascending), { id, price });
+            else
+                up.insert(lower_bound(up.begin(), up.end(), price, descending), { id, price });
+        }
+
+        bool remove(Cross cross, size_t id, double price) {
+            vector<Entry>& entries = cross == CROSS_DOWN ? down : up;
+            auto it = cross == CROSS_DOWN
+                ? lower_bound(entries.begin(), entries.end(), price, ascending)
+                : lower_bound(entries.begin(), entries.end(), price, descending);
+            for (; it != entries.end() && it->price == price; ++it)
+                if (it->id == id) {
+                    entries.erase(it);
+                    return true;
+                }
+            return false;
+        }
+
+        // moves the entries reached between low and high into crossed (appended)
+        void cross(double low, double high, vector<Crossed>& crossed) {
+            while (!down.empty() && down.back().price >= low) {
+                crossed.push_back({ CROSS_DOWN, down.back() });
+                down.pop_back();
+            }
+            while (!up.empty() && up.back().price <= high) {
+                crossed.push_back({ CROSS_UP, up.back() });
+                up.pop_back();
+            }
+        }
+    };
+
+}
\ No newline at end of file
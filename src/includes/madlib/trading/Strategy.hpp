@@ -7,6 +7,7 @@
 #include "../graph/MultiChartAccordion.hpp"
 
 #include "Exchange.hpp"
+#include "TradeJournal.hpp"
 #include "CandleHistoryChart.hpp"
 
 namespace madlib::trading {
@@ -95,6 +96,7 @@ namespace madlib::trading {
     protected:
 
         // map<string, Parameter>& parameters;
+        TradeJournal tradeJournal;
         CandleHistoryChart* candleHistoryChart = nullptr;
         Chart* balanceQuotedChart = nullptr;
         Chart* balanceBaseChart = nullptr;
@@ -121,8 +123,21 @@ namespace madlib::trading {
             throw ERR_UNIMP;
         }
 
+        // called after the last candle, e.g. to build chart shapes from what the run recorded
+        virtual void onFinish(Exchange*&, const string&) {}
+
+        // tunable numeric parameters by name (e.g. for a parameter sweep)
+        virtual void setParameter(const string& name, double) {
+            throw ERROR("Unknown strategy parameter: " + name);
+        }
+
+        TradeJournal& getTradeJournal() {
+            return tradeJournal;
+        }
+
         void setCandleHistoryChart(CandleHistoryChart* candleHistoryChart) {
             this->candleHistoryChart = candleHistoryChart;
+            if (candleHistoryChart) candleHistoryChart->setTradeJournal(&tradeJournal);
         }
 
         void setBalanceQuotedChart(Chart* balanceQuotedChart) {
@@ -137,68 +152,73 @@ namespace madlib::trading {
             this->multichartAccordion = multichartAccordion;
         }
 
-        void addBuyText(Exchange*& exchange, const string& symbol, ms_t currentTime = 0, double currentPrice = 0, const string& text = "BUY", Color color = Theme::defaultTradeLabelBuyColor) {
-            if (!candleHistoryChart) return;
-            LabelSeries* labelSeries = candleHistoryChart->getLabelSeries();
-            if (!labelSeries) return;
-            if (!currentTime) currentTime = exchange->getCurrentTime();
-            if (!currentPrice) currentPrice = exchange->getPairAt(symbol).getPrice();
-            Chart* chart = (Chart*)labelSeries->getTimeRangeArea();
-            labelSeries->getShapes().push_back(chart->createLabelShape(currentTime, currentPrice, text, color));
-            // addText(labelSeries.getBuyTextRealChoords(), labelSeries.getBuyTexts(), currentTime, currentPrice, text);
+        // quiet orders for strategies that probe a lot, only the journal records the rejected ones
+        Exchange::OrderStatus executeMarketBuy(Exchange*& exchange, pair_id_t pairId, double amount) {
+            ms_t currentTime = exchange->getCurrentTime();
+            const Pair& pair = exchange->getPairAt(pairId);
+            double currentPrice = pair.getPrice();
+            Exchange::OrderStatus status = exchange->executeMarketBuy(pairId, amount);
+            if (status == Exchange::ORDER_FILLED) {
+                double fee = amount * pair.getFees().getMarketBuyPc() * currentPrice;
+                tradeJournal.record(currentTime, currentPrice, amount, fee, TradeJournal::BUY, TradeJournal::FILLED);
+            } else tradeJournal.record(currentTime, currentPrice, amount, 0, TradeJournal::BUY, TradeJournal::FAILED);
+            return status;
         }
 
-        void addSellText(Exchange*& exchange, const string& symbol, ms_t currentTime = 0, double currentPrice = 0, const string& text = "SELL", Color color = Theme::defaultTradeLabelSellColor) {
-            if (!candleHistoryChart) return;
-            LabelSeries* labelSeries = candleHistoryChart->getLabelSeries();
-            if (!labelSeries) return;
-            if (!currentTime) currentTime = exchange->getCurrentTime();
-            if (!currentPrice) currentPrice = exchange->getPairAt(symbol).getPrice();
-            Chart* chart = (Chart*)labelSeries->getTimeRangeArea();
-            labelSeries->getShapes().push_back(chart->createLabelShape(currentTime, currentPrice, text, color));
-            // addText(labelSeries.getSellTextRealChoords(), labelSeries.getSellTexts(), currentTime, currentPrice, text);
+        Exchange::OrderStatus executeMarketSell(Exchange*& exchange, pair_id_t pairId, double amount) {
+            ms_t currentTime = exchange->getCurrentTime();
+            const Pair& pair = exchange->getPairAt(pairId);
+            double currentPrice = pair.getPrice();
+            Exchange::OrderStatus status = exchange->executeMarketSell(pairId, amount);
+            if (status == Exchange::ORDER_FILLED) {
+                double fee = amount * currentPrice * pair.getFees().getMarketSellPc();
+                tradeJournal.record(currentTime, currentPrice, amount, fee, TradeJournal::SELL, TradeJournal::FILLED);
+            } else tradeJournal.record(currentTime, currentPrice, amount, 0, TradeJournal::SELL, TradeJournal::FAILED);
+            return status;
         }
 
-        void addErrorText(Exchange*& exchange, const string& symbol, ms_t currentTime = 0, double currentPrice = 0, const string& text = "ERROR", Color color = Theme::defaultTradeLabelErrorColor) {
-            if (!candleHistoryChart) return;
-            LabelSeries* labelSeries = candleHistoryChart->getLabelSeries();
-            if (!labelSeries) return;
-            if (!currentTime) currentTime = exchange->getCurrentTime();
-            if (!currentPrice) currentPrice = exchange->getPairAt(symbol).getPrice();
-            Chart* chart = (Chart*)labelSeries->getTimeRangeArea();
-            labelSeries->getShapes().push_back(chart->createLabelShape(currentTime, currentPrice, text, color));
-            // addText(labelSeries.getErrorTextRealChoords(), labelSeries.getErrorTexts(), currentTime, currentPrice, text);
+        // journals a resting order the exchange filled, false when it was not filled
+        bool recordFill(Exchange*& exchange, order_id_t orderId) {
+            Exchange::Fill fill;
+            if (!exchange->findFill(orderId, fill)) return false;
+            const double fee = fill.side == Exchange::BUY ? fill.fee * fill.price : fill.fee;
+            tradeJournal.record(
+                fill.time, fill.price, fill.amount, fee, 
+                fill.side == Exchange::BUY ? TradeJournal::BUY : TradeJournal::SELL, 
+                TradeJournal::FILLED
+            );
+            return true;
         }
 
-        bool marketBuy(Exchange*& exchange, const string& symbol, double amount) {
-            ms_t currentTime = exchange->getCurrentTime();
-            double currentPrice = exchange->getPairAt(symbol).getPrice();
-            if (exchange->marketBuy(symbol, amount, false)) {
-                addBuyText(exchange, symbol, currentTime, currentPrice);
-                return true;
-            }
+        bool marketBuy(Exchange*& exchange, pair_id_t pairId, double amount) {
+            Exchange::OrderStatus status = executeMarketBuy(exchange, pairId, amount);
+            if (status == Exchange::ORDER_FILLED) return true;
             LOGA(
-                " Exchange time: " + ms_to_datetime(currentTime) 
-                + ", Strategy BUY Error, [" + symbol + "] " + to_string(amount)
+                " Exchange time: " + ms_to_datetime(exchange->getCurrentTime()) 
+                + ", Strategy BUY Error, [" + exchange->getSymbol(pairId) + "] " + to_string(amount)
+                + ": " + Exchange::getOrderStatusName(status)
             );
-            addErrorText(exchange, symbol, currentTime, currentPrice);
             return false;
         }
 
-        bool marketSell(Exchange*& exchange, const string& symbol, double amount) {
-            ms_t currentTime = exchange->getCurrentTime();
-            double currentPrice = exchange->getPairAt(symbol).getPrice();
-            if (exchange->marketSell(symbol, amount, false)) {
-                addSellText(exchange, symbol, currentTime, currentPrice);
-                return true;
-            }
+        bool marketBuy(Exchange*& exchange, const string& symbol, double amount) {
+            return marketBuy(exchange, exchange->getPairId(symbol), amount);
+        }
+
+        bool marketSell(Exchange*& exchange, pair_id_t pairId, double amount) {
+            Exchange::OrderStatus status = executeMarketSell(exchange, pairId, amount);
+            if (status == Exchange::ORDER_FILLED) return true;
             LOGA(
-                " Exchange time: " + ms_to_datetime(currentTime) 
-                + ", Strategy SELL Error, [" + symbol + "] " + to_string(amount)
+                " Exchange time: " + ms_to_datetime(exchange->getCurrentTime()) 
+                + ", Strategy SELL Error, [" + exchange->getSymbol(pairId) + "] " + to_string(amount)
+                + ": " + Exchange::getOrderStatusName(status)
             );
-            addErrorText(exchange, symbol, currentTime, currentPrice);
             return false;
         }
+
+        bool marketSell(Exchange*& exchange, const string& symbol, double amount) {
+            return marketSell(exchange, exchange->getPairId(symbol), amount);
+        }
     };
   
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Fees.hpp"
 #include "Balance.hpp"
 #include "Exchange.hpp"
+#include "PriceBook.hpp"
 
 namespace madlib::trading {
     
@@ -22,18 +23,152 @@ namespace madlib::trading {
             Balance& quotedBalance;
         };
 
-        MarketOrderInfos getMarketOrderInfos(const string& symbol) {
-            const Pair& pair = pairs.at(symbol);
-            const Fees& fees = pair.getFees();
-            const double price = pair.getPrice();
+        // resting orders, their funds stay in the balances but are locked:
+        // market orders and new resting orders can only spend the rest
+        struct OpenOrder {
+            pair_id_t pairId;
+            OrderSide side;
+            OrderType type;
+            PriceBook::Cross cross;
+            double price;
+            double amount;
+            double locked; // the two legs of an OCO share the lock of the first one
+            order_id_t linkedId; // the other leg of an OCO
+        };
+        map<order_id_t, OpenOrder> openOrders;
+        vector<PriceBook> books; // by pair id
+        vector<double> lockedAmounts; // by currency id
+        order_id_t lastOrderId = 0;
+        vector<PriceBook::Crossed> crossed; // reused by matchOrders()
+
+        double& lockedAt(currency_id_t currencyId) {
+            if (currencyId >= lockedAmounts.size()) lockedAmounts.resize(currencyId + 1, 0);
+            return lockedAmounts[currencyId];
+        }
+
+        PriceBook& bookAt(pair_id_t pairId) {
+            if (pairId >= books.size()) books.resize(pairId + 1);
+            return books[pairId];
+        }
+
+        bool canSpend(currency_id_t currencyId, double amount) {
+            return getBalanceAt(currencyId).canDecrement(amount + lockedAt(currencyId));
+        }
+
+        currency_id_t getSpentCurrencyId(pair_id_t pairId, OrderSide side) const {
+            return side == BUY ? getQuotedCurrencyId(pairId) : getBaseCurrencyId(pairId);
+        }
+
+        // a limit or take-profit is reached from the good side, a stop-loss from the bad side
+        static PriceBook::Cross getCross(OrderSide side, OrderType type) {
+            const bool down = side == BUY ? type != STOP_LOSS : type == STOP_LOSS;
+            return down ? PriceBook::CROSS_DOWN : PriceBook::CROSS_UP;
+        }
+
+        OrderStatus validateOrder(pair_id_t pairId, OrderSide side, double amount, double price, double& locked) {
+            if (!(amount > 0)) return ORDER_INVALID_AMOUNT;
+            if (!(price > 0)) return ORDER_INVALID_PRICE;
+            locked = side == BUY ? amount * price : amount;
+            if (!canSpend(getSpentCurrencyId(pairId, side), locked)) return ORDER_INSUFFICIENT_FUNDS;
+            return ORDER_OPEN;
+        }
+
+        order_id_t placeOrder(
+            pair_id_t pairId, OrderSide side, OrderType type, 
+            double amount, double price, double locked, order_id_t linkedId = 0
+        ) {
+            lockedAt(getSpentCurrencyId(pairId, side)) += locked;
+            const order_id_t orderId = ++lastOrderId;
+            const PriceBook::Cross cross = getCross(side, type);
+            openOrders.insert({ orderId, { pairId, side, type, cross, price, amount, locked, linkedId } });
+            bookAt(pairId).add(cross, orderId, price);
+            return orderId;
+        }
+
+        OrderStatus placeSingleOrder(
+            pair_id_t pairId, OrderSide side, OrderType type, 
+            double amount, double price, order_id_t& orderId
+        ) {
+            orderId = 0;
+            double locked;
+            OrderStatus status = validateOrder(pairId, side, amount, price, locked);
+            if (status != ORDER_OPEN) return status;
+            orderId = placeOrder(pairId, side, type, amount, price, locked);
+            return ORDER_OPEN;
+        }
+
+        // removes an open order from its book and releases its lock
+        void closeOrder(map<order_id_t, OpenOrder>::iterator it) {
+            const OpenOrder& order = it->second;
+            bookAt(order.pairId).remove(order.cross, it->first, order.price);
+            lockedAt(getSpentCurrencyId(order.pairId, order.side)) -= order.locked;
+            openOrders.erase(it);
+        }
+
+        /**
+         * At the given price (see matchOrders()), the funds were locked at
+         * the order's price when it was placed, and the lock is released by
+         * now. A buy filled above its price (a gapped buy stop) costs more
+         * than it locked, it only buys what the free quoted funds cover.
+         * Both balances are checked before either one changes, an order the
+         * balances can not take is dropped into getRejects(), not filled.
+         * Stop-losses pay the market fees, limits and take-profits the limit fees.
+         */
+        bool fillOrder(order_id_t orderId, const OpenOrder& order, double price) {
+            const Fees& fees = getPairAt(order.pairId).getFees();
+            Balance& baseBalance = getBaseBalanceAt(order.pairId);
+            Balance& quotedBalance = getQuotedBalanceAt(order.pairId);
+            double amount = order.amount;
+            double cost = amount * price;
+            const bool market = order.type == STOP_LOSS;
+            double fee;
+            if (order.side == BUY) {
+                const currency_id_t quotedId = getQuotedCurrencyId(order.pairId);
+                bool spendable = canSpend(quotedId, cost);
+                if (!spendable && price > order.price) {
+                    // the free funds, so no other order's lock is spent
+                    cost = max(quotedBalance.getAmount() - lockedAt(quotedId), 0.0);
+                    amount = cost / price;
+                    spendable = quotedBalance.canDecrement(cost);
+                }
+                fee = amount * (market ? fees.getMarketBuyPc() : fees.getLimitBuyPc());
+                if (!(amount > 0) || !spendable || !baseBalance.canIncrement(amount - fee)) {
+                    rejects.push_back(orderId);
+                    return false;
+                }
+                quotedBalance.decrement(cost, false);
+                baseBalance.increment(amount - fee, false);
+            } else {
+                fee = cost * (market ? fees.getMarketSellPc() : fees.getLimitSellPc());
+                if (
+                    !canSpend(getBaseCurrencyId(order.pairId), amount) || 
+                    !quotedBalance.canIncrement(cost - fee)
+                ) {
+                    rejects.push_back(orderId);
+                    return false;
+                }
+                baseBalance.decrement(amount, false);
+                quotedBalance.increment(cost - fee, false);
+            }
+            fills.push_back({ orderId, order.pairId, order.side, order.type, currentTime, price, amount, fee });
+            return true;
+        }
+
+        MarketOrderInfos getMarketOrderInfos(pair_id_t pairId) {
+            const Pair& pair = getPairAt(pairId);
             return { 
-                price, 
-                fees, 
-                balances.at(pair.getBaseCurrency()), 
-                balances.at(pair.getQuotedCurrency()) 
+                pair.getPrice(), 
+                pair.getFees(), 
+                getBaseBalanceAt(pairId), 
+                getQuotedBalanceAt(pairId) 
             };
         }
 
+    protected:
+
+        vector<Fill> fills; // see matchOrders()
+        vector<order_id_t> rejects; // reached but not filled, see fillOrder()
+
     public:
         // struct Args {
         //     const vector<string>& periods;
@@ -78,31 +213,185 @@ namespace madlib::trading {
             return currentTime;
         }
 
-        virtual bool marketBuy(const string& symbol, double amount, bool throws = true) override {
-            MarketOrderInfos marketOrderInfos = getMarketOrderInfos(symbol);
+        virtual OrderStatus executeMarketBuy(pair_id_t pairId, double amount) override {
+            MarketOrderInfos marketOrderInfos = getMarketOrderInfos(pairId);
+            if (!(amount > 0)) return ORDER_INVALID_AMOUNT;
+            if (!(marketOrderInfos.price > 0)) return ORDER_INVALID_PRICE;
             double cost = amount * marketOrderInfos.price;
             double fee = amount * marketOrderInfos.fees.getMarketBuyPc();
-            return marketOrderInfos.quotedBalance.decrement(cost, throws)
-                && marketOrderInfos.baseBalance.increment(amount - fee, throws);
+            if (
+                !canSpend(getQuotedCurrencyId(pairId), cost) || 
+                !marketOrderInfos.baseBalance.canIncrement(amount - fee)
+            ) return ORDER_INSUFFICIENT_FUNDS;
+            marketOrderInfos.quotedBalance.decrement(cost, false);
+            marketOrderInfos.baseBalance.increment(amount - fee, false);
+            return ORDER_FILLED;
         }
 
-        virtual bool marketSell(const string& symbol, double amount, bool throws = true) override {
-            MarketOrderInfos marketOrderInfos = getMarketOrderInfos(symbol);
+        virtual OrderStatus executeMarketSell(pair_id_t pairId, double amount) override {
+            MarketOrderInfos marketOrderInfos = getMarketOrderInfos(pairId);
+            if (!(amount > 0)) return ORDER_INVALID_AMOUNT;
+            if (!(marketOrderInfos.price > 0)) return ORDER_INVALID_PRICE;
             double cost = amount * marketOrderInfos.price;
             double fee = cost * marketOrderInfos.fees.getMarketSellPc();
-            return marketOrderInfos.baseBalance.decrement(amount, throws)
-                && marketOrderInfos.quotedBalance.increment(cost - fee, throws);
+            if (
+                !canSpend(getBaseCurrencyId(pairId), amount) || 
+                !marketOrderInfos.quotedBalance.canIncrement(cost - fee)
+            ) return ORDER_INSUFFICIENT_FUNDS;
+            marketOrderInfos.baseBalance.decrement(amount, false);
+            marketOrderInfos.quotedBalance.increment(cost - fee, false);
+            return ORDER_FILLED;
         }
 
-        // TODO:
-        // virtual void limitBuy(const string& symbol, double amount, double limitPrice) {
-        //     throw ERR_UNIMP;
-        // }
+        virtual bool marketBuy(const string& symbol, double amount, bool throws = true) override {
+            return marketBuy(getPairId(symbol), amount, throws);
+        }
 
-        // TODO:
-        // virtual void limitSell(const string& symbol, double amount, double limitPrice) {
-        //     throw ERR_UNIMP;
-        // }
+        virtual bool marketBuy(pair_id_t pairId, double amount, bool throws = true) override {
+            OrderStatus status = executeMarketBuy(pairId, amount);
+            if (status == ORDER_FILLED) return true;
+            if (throws) throw ERROR("Market buy failed: " + string(getOrderStatusName(status)));
+            return false;
+        }
+
+        virtual bool marketSell(const string& symbol, double amount, bool throws = true) override {
+            return marketSell(getPairId(symbol), amount, throws);
+        }
+
+        virtual bool marketSell(pair_id_t pairId, double amount, bool throws = true) override {
+            OrderStatus status = executeMarketSell(pairId, amount);
+            if (status == ORDER_FILLED) return true;
+            if (throws) throw ERROR("Market sell failed: " + string(getOrderStatusName(status)));
+            return false;
+        }
+
+        virtual OrderStatus executeLimitBuy(pair_id_t pairId, double amount, double limitPrice, order_id_t& orderId) override {
+            return placeSingleOrder(pairId, BUY, LIMIT, amount, limitPrice, orderId);
+        }
+
+        virtual OrderStatus executeLimitSell(pair_id_t pairId, double amount, double limitPrice, order_id_t& orderId) override {
+            return placeSingleOrder(pairId, SELL, LIMIT, amount, limitPrice, orderId);
+        }
+
+        virtual OrderStatus executeStopLoss(pair_id_t pairId, OrderSide side, double amount, double stopPrice, order_id_t& orderId) override {
+            return placeSingleOrder(pairId, side, STOP_LOSS, amount, stopPrice, orderId);
+        }
+
+        virtual OrderStatus executeTakeProfit(pair_id_t pairId, OrderSide side, double amount, double takeProfitPrice, order_id_t& orderId) override {
+            return placeSingleOrder(pairId, side, TAKE_PROFIT, amount, takeProfitPrice, orderId);
+        }
+
+        virtual OrderStatus executeOco(
+            pair_id_t pairId, OrderSide side, double amount, double takeProfitPrice, double stopPrice,
+            order_id_t& takeProfitId, order_id_t& stopId
+        ) override {
+            takeProfitId = stopId = 0;
+            if (!(takeProfitPrice > 0) || !(stopPrice > 0)) return ORDER_INVALID_PRICE;
+            // a buy locks enough for the dearer leg
+            double locked;
+            OrderStatus status = validateOrder(pairId, side, amount, max(takeProfitPrice, stopPrice), locked);
+            if (status != ORDER_OPEN) return status;
+            takeProfitId = placeOrder(pairId, side, TAKE_PROFIT, amount, takeProfitPrice, locked);
+            stopId = placeOrder(pairId, side, STOP_LOSS, amount, stopPrice, 0, takeProfitId);
+            openOrders.at(takeProfitId).linkedId = stopId;
+            return ORDER_OPEN;
+        }
+
+        virtual void limitBuy(const string& symbol, double amount, double limitPrice) override {
+            order_id_t orderId;
+            OrderStatus status = executeLimitBuy(getPairId(symbol), amount, limitPrice, orderId);
+            if (status != ORDER_OPEN) throw ERROR("Limit buy failed: " + string(getOrderStatusName(status)));
+        }
+
+        virtual void limitSell(const string& symbol, double amount, double limitPrice) override {
+            order_id_t orderId;
+            OrderStatus status = executeLimitSell(getPairId(symbol), amount, limitPrice, orderId);
+            if (status != ORDER_OPEN) throw ERROR("Limit sell failed: " + string(getOrderStatusName(status)));
+        }
+
+        // cancels both legs of an OCO
+        virtual bool cancelOrder(order_id_t orderId) override {
+            auto it = openOrders.find(orderId);
+            if (it == openOrders.end()) return false;
+            const order_id_t linkedId = it->second.linkedId;
+            closeOrder(it);
+            auto linked = openOrders.find(linkedId);
+            if (linked != openOrders.end()) closeOrder(linked);
+            return true;
+        }
+
+        virtual bool isOrderOpen(order_id_t orderId) const override {
+            return openOrders.count(orderId) == 1;
+        }
+
+        size_t getOpenOrderCount() const {
+            return openOrders.size();
+        }
+
+        double getLockedAmount(currency_id_t currencyId) const {
+            return currencyId < lockedAmounts.size() ? lockedAmounts[currencyId] : 0;
+        }
+
+        static bool isReached(const OpenOrder& order, double low, double high) {
+            return order.cross == PriceBook::CROSS_DOWN ? order.price >= low : order.price <= high;
+        }
+
+        /**
+         * Fills the resting orders of the pair that a candle's price range
+         * reached, only those are touched (the books are sorted by price).
+         * When a candle reaches both legs of an OCO, the order of the prices
+         * inside it is unknown, so the stop-loss fills (the worse case) and
+         * the take-profit is cancelled, for buys and sells alike.
+         * An order reached through a gap (e.g. a sell stop above the candle's
+         * high) fills at the candle's edge, not at a price that never traded,
+         * a gapped buy stop may then fill only a part (see fillOrder()).
+         * Returns the number of fills, they are appended to getFills(), the
+         * reached orders the balances could not take go to getRejects().
+         */
+        size_t matchOrders(pair_id_t pairId, double low, double high) {
+            if (pairId >= books.size() || books[pairId].empty()) return 0;
+            crossed.clear();
+            books[pairId].cross(low, high, crossed);
+            size_t filled = 0;
+            for (const PriceBook::Crossed& entry: crossed) {
+                auto it = openOrders.find(entry.entry.id);
+                if (it == openOrders.end()) continue; // the other leg of an OCO filled already
+                const OpenOrder order = it->second;
+                if (order.type != STOP_LOSS && order.linkedId) {
+                    auto stop = openOrders.find(order.linkedId);
+                    // cancelled when the stop fills, its book entry is popped already
+                    if (stop != openOrders.end() && isReached(stop->second, low, high)) continue;
+                }
+                // the book entry is popped already, closeOrder() only releases the lock here
+                closeOrder(it);
+                if (order.linkedId) cancelOrder(order.linkedId);
+                const double price = order.cross == PriceBook::CROSS_DOWN ? min(order.price, high) : max(order.price, low);
+                if (fillOrder(entry.entry.id, order, price)) filled++;
+            }
+            return filled;
+        }
+
+        const vector<Fill>& getFills() const {
+            return fills;
+        }
+
+        virtual bool findFill(order_id_t orderId, Fill& fill) const override {
+            for (size_t i = fills.size(); i-- > 0;)
+                if (fills[i].orderId == orderId) {
+                    fill = fills[i];
+                    return true;
+                }
+            return false;
+        }
+
+        const vector<order_id_t>& getRejects() const {
+            return rejects;
+        }
+
+        void clearFills() {
+            fills.clear();
+            rejects.clear();
+        }
     };
 
 }
\ No newline at end of file
@@ -18,6 +18,7 @@ namespace madlib::trading {
             ms_t currentEnd = currentStart + period;
 
             candles.clear();
+            invalidateCandleColumns();
             while (tradeEventIter != trades.end()) {
                 double open = tradeEventIter->price;
                 double close = open;
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include "../../../../libs/clib/clib/time.hpp"
+
+using namespace std;
+using namespace clib;
+
+namespace madlib::trading {
+
+    /**
+     * Order events of a strategy as plain records in a preallocated
+     * array. Strategies only write here while backtesting, charts and
+     * reports read the records later (e.g. labels are built on draw).
+     */
+    class TradeJournal {
+    public:
+
+        enum Side: unsigned char { BUY, SELL };
+        enum EventStatus: unsigned char { FILLED, FAILED };
+
+        struct Event {
+            ms_t time;
+            double price;
+            double amount; // in the base currency
+            double fee; // in the quoted currency
+            Side side;
+            EventStatus status;
+        };
+
+    protected:
+
+        vector<Event> events;
+
+    public:
+
+        explicit TradeJournal(size_t capacity = 1024) {
+            events.reserve(capacity);
+        }
+
+        virtual ~TradeJournal() {}
+
+        // keeps the capacity so reruns do not allocate again
+        void clear() {
+            events.clear();
+        }
+
+        void reserve(size_t capacity) {
+            events.reserve(capacity);
+        }
+
+        void record(ms_t time, double price, double amount, double fee, Side side, EventStatus status) {
+            events.push_back({ time, price, amount, fee, side, status });
+        }
+
+        size_t size() const {
+            return events.size();
+        }
+
+        bool empty() const {
+            return events.empty();
+        }
+
+        const Event& at(size_t i) const {
+            return events.at(i);
+        }
+
+        const vector<Event>& getEvents() const {
+            return events;
+        }
+
+        size_t count(Side side, EventStatus status = FILLED) const {
+            size_t n = 0;
+            for (const Event& event: events)
+                if (event.side == side && event.status == status) n++;
+            return n;
+        }
+
+        double getFeesTotal() const {
+            double total = 0;
+            for (const Event& event: events)
+                if (event.status == FILLED) total += event.fee;
+            return total;
+        }
+    };
+
+}
\ No newline at end of file
@@ -35,10 +35,13 @@ namespace madlib::trading {
 
         void calc(ms_t time, double value) {
             ema = (ema * length + value) / (length + 1);
+            project(time, ema);
+        }
 
-            emaProjector->getShapes().push_back(
-                candleHistoryChart->createPointShape(time, ema)
-            );
+        // shows an already calculated value (e.g. by indicator_ema)
+        void project(ms_t time, double ema) {
+            this->ema = ema;
+            emaProjector->addPoint(time, ema);
         }
 
     };
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "../../../../../libs/clib/clib/err.hpp"
+
+#include "../../simd.hpp"
+
+using namespace std;
+using namespace clib;
+
+namespace madlib::trading {
+
+    /**
+     * Batch indicators over whole columns (e.g. CandleColumns::getCloses().data()).
+     * Every output is a caller allocated array of n values, the warm up
+     * values (where the window is not full yet) are NAN.
+     * Elementwise stages use the packed doubles of simd.hpp, the
+     * recurrences (EMA, Wilder smoothing, running sums) stay scalar.
+     */
+
+    // ---- elementwise stages ----
+
+    inline void kernel_min(const double* a, const double* b, size_t n, double* out) {
+        size_t i = 0;
+#ifdef MADLIB_SIMD
+        for (; i + simd::width <= n; i += simd::width)
+            simd::store(out + i, simd::min(simd::load(a + i), simd::load(b + i)));
+#endif
+        for (; i < n; i++) out[i] = a[i] < b[i] ? a[i] : b[i];
+    }
+
+    inline void kernel_max(const double* a, const double* b, size_t n, double* out) {
+        size_t i = 0;
+#ifdef MADLIB_SIMD
+        for (; i + simd::width <= n; i += simd::width)
+            simd::store(out + i, simd::max(simd::load(a + i), simd::load(b + i)));
+#endif
+        for (; i < n; i++) out[i] = a[i] > b[i] ? a[i] : b[i];
+    }
+
+    // gains[i] = max(in[i] - in[i - 1], 0), losses[i] = max(in[i - 1] - in[i], 0), the first ones are 0
+    inline void kernel_gains_losses(const double* in, size_t n, double* gains, double* losses) {
+        if (!n) return;
+        gains[0] = losses[0] = 0;
+        size_t i = 1;
+#ifdef MADLIB_SIMD
+        const simd::vec zero = simd::set1(0);
+        for (; i + simd::width <= n; i += simd::width) {
+            simd::vec diff = simd::sub(simd::load(in + i), simd::load(in + i - 1));
+            simd::store(gains + i, simd::max(diff, zero));
+            simd::store(losses + i, simd::max(simd::sub(zero, diff), zero));
+        }
+#endif
+        for (; i < n; i++) {
+            double diff = in[i] - in[i - 1];
+            gains[i] = diff > 0 ? diff : 0;
+            losses[i] = diff < 0 ? -diff : 0;
+        }
+    }
+
+    // max(high - low, |high - previous close|, |low - previous close|)
+    inline void kernel_true_range(const double* highs, const double* lows, const double* closes, size_t n, double* out) {
+        if (!n) return;
+        out[0] = highs[0] - lows[0];
+        size_t i = 1;
+#ifdef MADLIB_SIMD
+        for (; i + simd::width <= n; i += simd::width) {
+            simd::vec high = simd::load(highs + i);
+            simd::vec low = simd::load(lows + i);
+            simd::vec prev = simd::load(closes + i - 1);
+            simd::vec range = simd::max(
+                simd::sub(high, low),
+                simd::max(simd::abs(simd::sub(high, prev)), simd::abs(simd::sub(low, prev)))
+            );
+            simd::store(out + i, range);
+        }
+#endif
+        for (; i < n; i++) {
+            double range = highs[i] - lows[i];
+            double up = fabs(highs[i] - closes[i - 1]);
+            double down = fabs(lows[i] - closes[i - 1]);
+            out[i] = range > up ? (range > down ? range : down) : (up > down ? up : down);
+        }
+    }
+
+    // (high + low + close) / 3 * volume
+    inline void kernel_typical_volume(
+        const double* highs, const double* lows, const double* closes, const double* volumes,
+        size_t n, double* out
+    ) {
+        size_t i = 0;
+#ifdef MADLIB_SIMD
+        const simd::vec third = simd::set1(1.0 / 3.0);
+        for (; i + simd::width <= n; i += simd::width) {
+            simd::vec typical = simd::mul(
+                simd::add(simd::add(simd::load(highs + i), simd::load(lows + i)), simd::load(closes + i)),
+                third
+            );
+            simd::store(out + i, simd::mul(typical, simd::load(volumes + i)));
+        }
+#endif
+        for (; i < n; i++) out[i] = (highs[i] + lows[i] + closes[i]) * (1.0 / 3.0) * volumes[i];
+    }
+
+    // ---- indicators ----
+
+    // same recurrence as EmaIndicator::calc: ema = (ema * length + value) / (length + 1)
+    inline void indicator_ema(const double* in, size_t n, double length, double seed, double* out) {
+        const double weight = 1.0 / (length + 1);
+        double ema = seed;
+        for (size_t i = 0; i < n; i++) out[i] = ema = (ema * length + in[i]) * weight;
+    }
+
+    inline void indicator_sma(const double* in, size_t n, size_t period, double* out) {
+        if (!period) throw ERROR("Invalid SMA period");
+        double sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            sum += in[i];
+            if (i >= period) sum -= in[i - period];
+            out[i] = i + 1 >= period ? sum / (double)period : NAN;
+        }
+    }
+
+    // Wilder's RSI
+    inline void indicator_rsi(const double* in, size_t n, size_t period, double* out) {
+        if (!period) throw ERROR("Invalid RSI period");
+        vector<double> gains(n), losses(n);
+        kernel_gains_losses(in, n, gains.data(), losses.data());
+        double gain = 0, loss = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (i <= period) {
+                gain += gains[i];
+                loss += losses[i];
+                if (i < period) {
+                    out[i] = NAN;
+                    continue;
+                }
+                gain /= (double)period;
+                loss /= (double)period;
+            } else {
+                gain = (gain * (double)(period - 1) + gains[i]) / (double)period;
+                loss = (loss * (double)(period - 1) + losses[i]) / (double)period;
+            }
+            out[i] = loss == 0 ? 100 : 100 - 100 / (1 + gain / loss);
+        }
+    }
+
+    /**
+     * Rolling minimum/maximum (van Herk/Gil-Werman): prefix and suffix
+     * extremes inside period sized blocks, every window is then the
+     * combination of one suffix and one prefix value.
+     */
+    inline void indicator_rolling_extreme(const double* in, size_t n, size_t period, double* out, bool maximum) {
+        if (!period) throw ERROR("Invalid rolling window period");
+        if (!n) return;
+        vector<double> prefix(n), suffix(n);
+        for (size_t i = 0; i < n; i++)
+            prefix[i] = i % period == 0 ? in[i] :
+                (maximum ? (prefix[i - 1] > in[i] ? prefix[i - 1] : in[i]) : (prefix[i - 1] < in[i] ? prefix[i - 1] : in[i]));
+        for (size_t i = n; i-- > 0;)
+            suffix[i] = i % period == period - 1 || i == n - 1 ? in[i] :
+                (maximum ? (suffix[i + 1] > in[i] ? suffix[i + 1] : in[i]) : (suffix[i + 1] < in[i] ? suffix[i + 1] : in[i]));
+        const size_t warmup = period - 1 < n ? period - 1 : n;
+        for (size_t i = 0; i < warmup; i++) out[i] = NAN;
+        if (warmup == n) return;
+        if (maximum) kernel_max(suffix.data(), prefix.data() + warmup, n - warmup, out + warmup);
+        else kernel_min(suffix.data(), prefix.data() + warmup, n - warmup, out + warmup);
+    }
+
+    inline void indicator_rolling_min(const double* in, size_t n, size_t period, double* out) {
+        indicator_rolling_extreme(in, n, period, out, false);
+    }
+
+    inline void indicator_rolling_max(const double* in, size_t n, size_t period, double* out) {
+        indicator_rolling_extreme(in, n, period, out, true);
+    }
+
+    // Wilder's average true range
+    inline void indicator_atr(
+        const double* highs, const double* lows, const double* closes,
+        size_t n, size_t period, double* out
+    ) {
+        if (!period) throw ERROR("Invalid ATR period");
+        vector<double> ranges(n);
+        kernel_true_range(highs, lows, closes, n, ranges.data());
+        double atr = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (i < period) {
+                atr += ranges[i];
+                out[i] = i + 1 == period ? (atr /= (double)period) : NAN;
+                continue;
+            }
+            out[i] = atr = (atr * (double)(period - 1) + ranges[i]) / (double)period;
+        }
+    }
+
+    // middle = SMA, upper/lower = middle +/- deviations * population standard deviation
+    inline void indicator_bollinger(
+        const double* in, size_t n, size_t period, double deviations,
+        double* middle, double* upper, double* lower
+    ) {
+        if (!period) throw ERROR("Invalid Bollinger period");
+        if (!n) return;
+        // values are shifted by the first one to keep the running sums small
+        const double shift = in[0];
+        vector<double> variance(n);
+        double sum = 0, squares = 0;
+        for (size_t i = 0; i < n; i++) {
+            const double value = in[i] - shift;
+            sum += value;
+            squares += value * value;
+            if (i >= period) {
+                const double old = in[i - period] - shift;
+                sum -= old;
+                squares -= old * old;
+            }
+            if (i + 1 < period) {
+                middle[i] = upper[i] = lower[i] = variance[i] = NAN;
+                continue;
+            }
+            const double mean = sum / (double)period;
+            const double var = squares / (double)period - mean * mean;
+            middle[i] = mean + shift;
+            variance[i] = var > 0 ? var : 0;
+        }
+        size_t i = period - 1 < n ? period - 1 : n;
+#ifdef MADLIB_SIMD
+        const simd::vec k = simd::set1(deviations);
+        for (; i + simd::width <= n; i += simd::width) {
+            simd::vec mid = simd::load(middle + i);
+            simd::vec band = simd::mul(k, simd::sqrt(simd::load(variance.data() + i)));
+            simd::store(upper + i, simd::add(mid, band));
+            simd::store(lower + i, simd::sub(mid, band));
+        }
+#endif
+        for (; i < n; i++) {
+            const double band = deviations * sqrt(variance[i]);
+            upper[i] = middle[i] + band;
+            lower[i] = middle[i] - band;
+        }
+    }
+
+    // cumulative volume weighted average (typical) price from the first candle
+    inline void indicator_vwap(
+        const double* highs, const double* lows, const double* closes, const double* volumes,
+        size_t n, double* out
+    ) {
+        vector<double> weighted(n);
+        kernel_typical_volume(highs, lows, closes, volumes, n, weighted.data());
+        double price = 0, volume = 0;
+        for (size_t i = 0; i < n; i++) {
+            price += weighted[i];
+            volume += volumes[i];
+            out[i] = volume > 0 ? price / volume : (highs[i] + lows[i] + closes[i]) / 3;
+        }
+    }
+
+}
\ No newline at end of file
@@ -38,6 +38,6 @@ namespace madlib::trading {
     string ms_to_period(ms_t ms) {
         for (const auto& period: periods)
             if (period.second == ms) return period.first;
-        throw ERROR("No period string match to the millisec: " + ms);
+        throw ERROR("No period string match to the millisec: " + to_string(ms));
     }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <iostream>
 #include <cstdio>
+#include <cmath>
 
+#include "../libs/clib/clib/args.hpp"
 #include "../libs/clib/clib/time.hpp"
 #include "includes/madlib/Factory.hpp"
 #include "includes/madlib/graph/FrameApplication.hpp"
@@ -16,6 +18,7 @@
 #include "includes/madlib/trading/CandleStrategy.hpp"
 #include "includes/madlib/trading/CandleHistory.hpp"
 #include "includes/madlib/trading/CandleStrategyBacktesterMultiChartAccordion.hpp"
+#include "includes/madlib/trading/CandleStrategySweep.hpp"
 
 using namespace std;
 using namespace clib;
@@ -547,6 +550,126 @@ int backtest(int, const char* []) {
     return 0;
 }
 
+string args_get(const map<const string, string>& args, const string& key, const string& defval) {
+    auto it = args.find(key);
+    return it == args.end() || it->second.empty() ? defval : it->second;
+}
+
+string json_string(const string& value) {
+    string escaped = "\"";
+    for (const char c: value) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char code[7]; // FlawFinder: ignore
+                    snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+                    escaped += code;
+                } else escaped += c;
+        }
+    }
+    return escaped + "\"";
+}
+
+// JSON has no nan or inf
+string json_number(double value) {
+    return isfinite(value) ? to_string(value) : "null";
+}
+
+// Usage: backtest-headless [--history NAME] [--exchange NAME] [--strategy NAME] [--symbol SYMBOL]
+//            [--from DATETIME] [--to DATETIME] [--period PERIOD] [--params name=value,...]
+//            [--format json|csv] [--output FILE]
+int backtest_headless(int argc, const char* argv[]) {
+    const map<const string, string> args = args_parse(argc - 1, argv + 1);
+    const string historyName = args_get(args, "history", "BitstampCandleHistory");
+    const string exchangeName = args_get(args, "exchange", "DefaultTestExchange");
+    const string strategyName = args_get(args, "strategy", "MartingaleCandleStrategy");
+    const string symbol = args_get(args, "symbol", Config::symbol);
+    const string from = args_get(args, "from", ms_to_datetime(Config::startTime));
+    const string to = args_get(args, "to", ms_to_datetime(Config::endTime));
+    const string period = args_get(args, "period", Config::periods[0]);
+    const string params = args_get(args, "params", "");
+    const string format = args_get(args, "format", "json");
+    const string output = args_get(args, "output", "");
+    if (format != "json" && format != "csv") throw ERROR("Invalid format: " + format);
+
+    Factory<CandleHistory> candleHistoryFactory;
+    Factory<TestExchange> testExchangeFactory;
+    Factory<CandleStrategy> candleStrategyFactory;
+
+    CandleHistory* candleHistory = candleHistoryFactory.createInstance(
+        Config::candleHistoryPath + "/" + historyName + "/" + historyName + ".so",
+        symbol, datetime_to_ms(from), datetime_to_ms(to), period_to_ms(period)
+    );
+    TestExchange* testExchange = testExchangeFactory.createInstance(
+        Config::testExchangePath + "/" + exchangeName + "/" + exchangeName + ".so",
+        Config::periods, Config::symbols, Config::pairs, Config::balances
+    );
+    CandleStrategy* candleStrategy = candleStrategyFactory.createInstance(
+        Config::candleStrategyPath + "/" + strategyName + "/" + strategyName + ".so"
+    );
+    for (const string& param: str_split(",", params)) {
+        if (str_trim(param).empty()) continue;
+        vector<string> nameValue = str_split("=", param);
+        if (nameValue.size() != 2) throw ERROR("Invalid strategy parameter: " + param);
+        candleStrategy->setParameter(str_trim(nameValue[0]), parse<double>(str_trim(nameValue[1])));
+    }
+
+    Progress progress("Loading history...", true, true, true, true);
+    candleHistory->load(progress);
+
+    LOG("Headless backtest starts with ", candleHistory->getCandles().size(), " candles...");
+    CandleStrategySweep::Result result;
+    CandleStrategySweep::backtest(candleHistory, *testExchange, candleStrategy, symbol, result);
+    LOG("Headless backtest done.");
+
+    const map<const string, string> values = {
+        { "history", historyName },
+        { "exchange", exchangeName },
+        { "strategy", strategyName },
+        { "symbol", symbol },
+        { "period", period },
+        { "from", from },
+        { "to", to },
+    };
+    const vector<pair<string, double>> metrics = {
+        { "candles", (double)candleHistory->getCandles().size() },
+        { "balanceQuotedFullStart", result.balanceQuotedFullStart },
+        { "balanceQuotedFull", result.balanceQuotedFull },
+        { "profitPc", result.profitPc },
+        { "maxDrawdownPc", result.maxDrawdownPc },
+        { "balanceBase", testExchange->getBalanceBase(symbol) },
+        { "balanceQuoted", testExchange->getBalanceQuoted(symbol) },
+    };
+
+    string out;
+    if (format == "json") {
+        vector<string> fields;
+        for (const auto& value: values) fields.push_back(json_string(value.first) + ": " + json_string(value.second));
+        for (const auto& metric: metrics) fields.push_back(json_string(metric.first) + ": " + json_number(metric.second));
+        out = "{\n    " + str_concat(fields, ",\n    ") + "\n}\n";
+    } else {
+        vector<string> header, row;
+        for (const auto& value: values) {
+            header.push_back(value.first);
+            row.push_back(value.second);
+        }
+        for (const auto& metric: metrics) {
+            header.push_back(metric.first);
+            row.push_back(to_string(metric.second));
+        }
+        out = str_concat(header, ",") + "\n" + str_concat(row, ",") + "\n";
+    }
+
+    if (output.empty()) cout << out;
+    else if (!file_put_contents(output, out)) throw ERROR("Unable to write: " + output);
+    return 0;
+}
+
 int help(int, const char* argv[]) {
     cout <<
         "Usages: $ " << argv[0] << " [COMMAND] [OPTIONS...]\n"
@@ -554,6 +677,9 @@ int help(int, const char* argv[]) {
         // "   test-command\n\n"
         "   help\n\n"
         "   backtest\n\n" // TODO...
+        "   backtest-headless [--history NAME] [--exchange NAME] [--strategy NAME]\n"
+        "       [--symbol SYMBOL] [--from DATETIME] [--to DATETIME] [--period PERIOD]\n"
+        "       [--params name=value,...] [--format json|csv] [--output FILE]\n\n"
         << endl;
     return 0;
 }
@@ -564,6 +690,7 @@ int main(int argc, const char* argv[])
     try { 
         // if (argv[1] && !strcmp(argv[1], "test-command")) return test(argc, argv);
         if (argv[1] && !strcmp(argv[1], "backtest")) return backtest(argc, argv);
+        if (argv[1] && !strcmp(argv[1], "backtest-headless")) return backtest_headless(argc, argv);
     } catch (exception &e) {
         const string errmsg = "Exception in main thread: " + string(e.what());
         cout << errmsg << endl;
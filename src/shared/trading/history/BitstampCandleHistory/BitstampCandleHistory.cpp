@@ -1,4 +1,16 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+
+#include "../../../../includes/madlib/csv.hpp"
+#include "../../../../includes/madlib/datetime.hpp"
+#include "../../../../includes/madlib/MappedFile.hpp"
+#include "../../../../includes/madlib/trading/periods.hpp"
+#include "../../../../includes/madlib/trading/CandleAggregator.hpp"
 #include "../../../../includes/madlib/trading/CandleHistory.hpp"
+#include "../../../../includes/madlib/trading/CandleStore.hpp"
 
 namespace madlib::trading::history {
     
@@ -12,77 +24,246 @@ namespace madlib::trading::history {
         static const string csvFileTpl;
             
         static vector<Candle> bitstamp_read_candle_history_dat(const string& datFile) {
-            return vector_load<Candle>(datFile);
+            return CandleStore::load(datFile);
+        }
+
+        // Candles in the store are in ascending time order, 
+        // so the [startTime, endTime] window is found by binary search.
+        static void bitstamp_find_candle_range(
+            const vector<ms_t>& starts, const vector<ms_t>& ends,
+            ms_t startTime, ms_t endTime,
+            size_t& from, size_t& to
+        ) {
+            from = (size_t)(lower_bound(starts.begin(), starts.end(), startTime) - starts.begin());
+            to = (size_t)(upper_bound(ends.begin() + (long)from, ends.end(), endTime) - ends.begin());
+        }
+
+        // shared by the parser threads, the caller reports the progress and cancels
+        struct BitstampCsvParseState {
+            atomic<size_t> parsed{0}; // bytes
+            atomic<size_t> finished{0}; // chunks
+            atomic<bool> canceled{false};
+        };
+
+        struct BitstampCsvChunk {
+            CsvField data;
+            ms_t period;
+            BitstampCsvParseState* state;
+            vector<Candle> candles;
+            exception_ptr error;
+        };
+
+        // cancels and joins the workers still running when the parse is left
+        // early (e.g. a thread could not be created), a joinable thread terminates
+        struct BitstampCsvWorkers {
+            BitstampCsvParseState& state;
+            vector<thread> threads;
+            ~BitstampCsvWorkers() {
+                for (thread& worker: threads)
+                    if (worker.joinable()) {
+                        state.canceled = true;
+                        worker.join();
+                    }
+            }
+        };
+
+        // returns false for rows that are not candle data (e.g. headers or empty lines)
+        static bool bitstamp_parse_candle_history_csv_row(
+            const char* line, const char* lineEnd, ms_t period, Candle& candle
+        ) {
+            const size_t fieldsMax = BitstampCandlesCsvField::VOLUME_QUOTED + 1;
+            CsvField fields[fieldsMax];
+            if (csv_split_line(line, lineEnd, fields, fieldsMax) <= BitstampCandlesCsvField::VOLUME_BASE) return false;
+            // prefer the numeric UNIX field, the date column is the fallback
+            double unixTime;
+            ms_t start;
+            if (csv_parse(fields[BitstampCandlesCsvField::UNIX], unixTime)) start = unix_to_ms(unixTime);
+            else {
+                CsvField date = fields[BitstampCandlesCsvField::DATE].trim();
+                if (date.size() != 19 || !datetime_fixed_to_ms(date.begin, start)) return false;
+            }
+            double open, close, low, high, volume;
+            if (
+                !csv_parse(fields[BitstampCandlesCsvField::OPEN], open) ||
+                !csv_parse(fields[BitstampCandlesCsvField::CLOSE], close) ||
+                !csv_parse(fields[BitstampCandlesCsvField::LOW], low) ||
+                !csv_parse(fields[BitstampCandlesCsvField::HIGH], high) ||
+                !csv_parse(fields[BitstampCandlesCsvField::VOLUME_BASE], volume)
+            ) throw ERROR("Invalid CSV row: [" + string(line, lineEnd) + "]");
+            candle = Candle(open, close, low, high, volume, start, start + period - 1);
+            return true;
+        }
+
+        static void bitstamp_parse_candle_history_csv_chunk(BitstampCsvChunk& chunk) {
+            const size_t reportLines = 4096;
+            try {
+                const char* end = chunk.data.end;
+                chunk.candles.reserve(chunk.data.size() / 64);
+                Candle candle;
+                const char* reported = chunk.data.begin;
+                size_t lines = 0;
+                for (const char* line = chunk.data.begin; line < end; line = csv_next_line(line, end)) {
+                    if (++lines % reportLines == 0) {
+                        if (chunk.state->canceled) break;
+                        chunk.state->parsed += (size_t)(line - reported);
+                        reported = line;
+                    }
+                    if (bitstamp_parse_candle_history_csv_row(line, csv_line_end(line, end), chunk.period, candle))
+                        chunk.candles.push_back(candle);
+                }
+                chunk.state->parsed += (size_t)(end - reported);
+            } catch (...) {
+                chunk.error = current_exception();
+            }
+            chunk.state->finished++;
+        }
+
+        /**
+         * Parses only the CSV rows newer than the last candle of an existing
+         * .dat file and appends them, the CSV is newest first so the parsing
+         * stops at the first row that is already ingested.
+         * @return the appended candles
+         */
+        static vector<Candle> bitstamp_append_candle_history_csv(
+            Progress& progress,
+            const string& csvFile,
+            const string& datFile
+        ) {
+            CandleStore store(datFile);
+            const ms_t lastStart = store.getLastStart();
+            if (!progress.update("Parse CSV (new rows): [" + csvFile + "]")) throw ERROR("User canceled");
+            MappedFile<char> csvData(csvFile);
+            const char* end = csvData.end();
+            vector<Candle> candles;
+            Candle candle;
+            for (const char* line = csvData.begin(); line < end; line = csv_next_line(line, end)) {
+                if (!bitstamp_parse_candle_history_csv_row(line, csv_line_end(line, end), store.getPeriod(), candle)) continue;
+                if (store.size() && candle.getStart() <= lastStart) break;
+                candles.push_back(candle);
+            }
+            if (candles.empty()) return candles;
+            reverse(candles.begin(), candles.end());
+            LOG("Appending " + to_string(candles.size()) + " candles: [" + datFile + "]");
+            store.append(candles);
+            return candles;
         }
 
         static vector<Candle> bitstamp_parse_candle_history_csv(
             Progress& progress,
             const string& csvFile,
             const string& datFile, 
+            const string& symbol,
             bool readOutFileIfExists = false,
             bool throwIfOutFileExists = false,
-            bool skipIfOutFileIsNewer = true
+            bool skipIfOutFileIsNewer = true,
+            bool incremental = true
         ) {
             if (!file_exists(csvFile)) 
                 throw ERROR("File not found: " + csvFile);
-            if (file_exists(datFile)) {
+            // files in an outdated or broken format are parsed again
+            if (file_exists(datFile) && CandleStore::isValid(datFile)) {
                 if (throwIfOutFileExists) throw ERROR("File already exists: " + datFile);
                 if (skipIfOutFileIsNewer && file_get_mtime(csvFile) < file_get_mtime(datFile)) {
                     if (readOutFileIfExists) return bitstamp_read_candle_history_dat(datFile);
                     else return {};
                 }
                 if (readOutFileIfExists) return bitstamp_read_candle_history_dat(datFile);
+                if (incremental) return bitstamp_append_candle_history_csv(progress, csvFile, datFile);
             }
             LOG(
                 string("Parsing Bitstamp candle history data:\n")
                     + "csv input file   : " + csvFile + "\n"
                     + "output data file : " + datFile
             );
-            vector<string> csvData = str_split("\n", file_get_contents(csvFile));
-
-            vector<Candle> candles;
-            const size_t csvDataSize = csvData.size();
+            MappedFile<char> csvData(csvFile);
             const size_t headerLines = 2;
-            
-            string firstLine = str_trim(csvData.at(headerLines));
-            vector<string> firstSplits = str_split(",", firstLine);
-            string firstDate = str_trim(firstSplits.at(BitstampCandlesCsvField::DATE));
-            string secondLine = str_trim(csvData.at(headerLines + 1));
-            vector<string> secondSplits = str_split(",", secondLine);
-            string secondDate = str_trim(secondSplits.at(BitstampCandlesCsvField::DATE));        
-            ms_t period = datetime_to_ms(firstDate) - datetime_to_ms(secondDate);
-
-            ms_t t = now();
-            for (size_t i = csvDataSize - 1; i >= headerLines; i--) {
-                string line = str_trim(csvData.at(i));
-                if (line.empty()) continue;
-                if (t < now() - 5 * second) {
-                    t = now();
-                    string msg = "Parse CSV: [" + line + "]";
-                    if (!progress.update(msg)) throw ERROR("User canceled");
-                    LOG(msg);
+            const char* begin = csvData.begin();
+            const char* end = csvData.end();
+            for (size_t i = 0; i < headerLines; i++) begin = csv_next_line(begin, end);
+
+            // period is the difference of the first two (newest) rows
+            Candle first, second;
+            const char* line = begin;
+            while (line < end && !bitstamp_parse_candle_history_csv_row(line, csv_line_end(line, end), 0, first))
+                line = csv_next_line(line, end);
+            line = csv_next_line(line, end);
+            while (line < end && !bitstamp_parse_candle_history_csv_row(line, csv_line_end(line, end), 0, second))
+                line = csv_next_line(line, end);
+            if (line >= end) throw ERROR("Not enough candle data in: " + csvFile);
+            const ms_t period = first.getStart() - second.getStart();
+
+            if (!progress.update("Parse CSV: [" + csvFile + "]")) throw ERROR("User canceled");
+            size_t threads = thread::hardware_concurrency();
+            if (!threads) threads = 1;
+            BitstampCsvParseState state;
+            vector<BitstampCsvChunk> chunks;
+            for (const CsvField& data: csv_split_chunks(begin, end, threads))
+                chunks.push_back({ data, period, &state, {}, nullptr });
+            BitstampCsvWorkers workers{ state, {} };
+            for (BitstampCsvChunk& chunk: chunks)
+                workers.threads.emplace_back(bitstamp_parse_candle_history_csv_chunk, ref(chunk));
+            const size_t bytes = (size_t)(end - begin);
+            ms_t next = 0;
+            while (state.finished < workers.threads.size()) {
+                const string msg = "Parse CSV: [" + csvFile + "] " + to_string(bytes ? state.parsed * 100 / bytes : 100) + "%";
+                if (!progress.update(msg, &next, 5 * MS_PER_SEC)) {
+                    state.canceled = true;
+                    break;
                 }
-                vector<string> fields = str_split(",", line);
-                if (!is_numeric(str_trim(fields.at(BitstampCandlesCsvField::UNIX)))) break;            
-                double open = parse<double>(str_trim(fields.at(BitstampCandlesCsvField::OPEN)));
-                double close = parse<double>(str_trim(fields.at(BitstampCandlesCsvField::CLOSE)));
-                double low = parse<double>(str_trim(fields.at(BitstampCandlesCsvField::LOW)));
-                double high = parse<double>(str_trim(fields.at(BitstampCandlesCsvField::HIGH)));
-                double volume = parse<double>(str_trim(fields.at(BitstampCandlesCsvField::VOLUME_BASE)));
-                ms_t start = datetime_to_ms(str_trim(fields.at(BitstampCandlesCsvField::DATE)));
-                ms_t end = start + period - 1;
-                Candle candle(open, close, low, high, volume, start, end);
-                candles.push_back(candle);
+                this_thread::sleep_for(chrono::milliseconds(50));
+            }
+            size_t total = 0;
+            for (size_t i = 0; i < workers.threads.size(); i++) {
+                workers.threads[i].join();
+                total += chunks[i].candles.size();
             }
+            if (state.canceled) throw ERROR("User canceled");
+            // the first error as it was thrown (already formatted)
+            for (const BitstampCsvChunk& chunk: chunks)
+                if (chunk.error) rethrow_exception(chunk.error);
+
+            // rows are newest first, merge the chunks in reverse order
+            vector<Candle> candles;
+            candles.reserve(total);
+            for (auto chunk = chunks.rbegin(); chunk != chunks.rend(); chunk++)
+                candles.insert(candles.end(), chunk->candles.rbegin(), chunk->candles.rend());
             LOG("Writing: [" + datFile + "]");
             const string path = path_extract(datFile);
             if (!file_exists(path)) {
                 file_create_path(path);
             }
-            vector_save(datFile, candles);
+            CandleStore::save(datFile, symbol, period, candles);
             return candles;
         }
 
+        /**
+         * Resamples a minute store into a store of the given period next to it,
+         * the cached file is kept while it was made from the same rows of the
+         * minute data (so minutes appended inside the last bucket rebuild it too).
+         */
+        static void bitstamp_aggregate_candle_history_dat(
+            Progress& progress,
+            const string& datFile,
+            const string& aggFile,
+            const string& symbol,
+            ms_t period
+        ) {
+            CandleStore store(datFile);
+            if (file_exists(aggFile) && CandleStore::isValid(aggFile)) {
+                CandleStore aggregated(aggFile);
+                if (
+                    aggregated.getPeriod() == period &&
+                    aggregated.getSourceCount() == store.size() &&
+                    aggregated.getSourceLastStart() == store.getLastStart()
+                ) return;
+            }
+            if (!progress.update("Aggregate: [" + aggFile + "]")) throw ERROR("User canceled");
+            LOG("Aggregating: [" + datFile + "] => [" + aggFile + "]");
+            vector<Candle> candles;
+            candles_aggregate(store, period, candles);
+            CandleStore::save(aggFile, symbol, period, candles, &store);
+        }
+
         static void bitstamp_download_candle_history_csv_all(
             Progress& progress,
             const string& symbol,
@@ -143,7 +324,7 @@ namespace madlib::trading::history {
                 if (!progress.update("Parse data " + to_string(year) + "...")) throw ERROR("User canceled");
                 const string csvFile = str_replace(_csvFileTpl, "{year}", to_string(year));
                 const string datFile = str_replace(_datFileTpl, "{year}", to_string(year));
-                bitstamp_parse_candle_history_csv(progress, csvFile, datFile, false, false);
+                bitstamp_parse_candle_history_csv(progress, csvFile, datFile, symbol, false, false);
                 progress.update(year, fromYear, toYear, false);
             }
         }
@@ -157,7 +338,7 @@ namespace madlib::trading::history {
         virtual ~BitstampCandleHistory() {};
 
         virtual void load(Progress& progress) override {
-            if (period != MS_PER_MIN) throw ERROR("Period works only on minutes charts"); // TODO: aggregate to other periods
+            if (period < MS_PER_MIN) throw ERROR("Period can not be shorter than a minute");
             int fromYear = parse<int>(ms_to_datetime(startTime).substr(0, 4));
             int toYear = parse<int>(ms_to_datetime(endTime).substr(0, 4));
             const map<string, string> repl = {
@@ -165,32 +346,63 @@ namespace madlib::trading::history {
                 {"{period}", "minute"},
             };
             string _datFileTpl = str_replace(datFileTpl, repl);
-            candles.clear();
-            for (int year = fromYear; year <= toYear; year++) {
-                if (!progress.update("Loading data " + to_string(year) + "...")) throw ERROR("User canceled");
-                const string datFile = str_replace(_datFileTpl, "{year}", to_string(year));
-                if (!file_exists(datFile)) {
+            string _aggFileTpl = str_replace(datFileTpl, {
+                {"{symbol}", symbol},
+                {"{period}", ms_to_period(period)},
+            });
+            vector<CandleStore*> stores;
+            vector<vector<ms_t>> starts, ends;
+            vector<pair<size_t, size_t>> ranges;
+            size_t total = 0;
+            try {
+                for (int year = fromYear; year <= toYear; year++) {
+                    if (!progress.update("Loading data " + to_string(year) + "...")) throw ERROR("User canceled");
+                    const string datFile = str_replace(_datFileTpl, "{year}", to_string(year));
                     string _csvFileTpl = str_replace(csvFileTpl, repl);
                     const string csvFile = str_replace(_csvFileTpl, "{year}", to_string(year));
-                    if (!file_exists(csvFile)) {
-                        bitstamp_download_candle_history_csv_all(progress, symbol, fromYear, toYear, "minute");
+                    if (!file_exists(datFile) || !CandleStore::isValid(datFile)) {
+                        if (!file_exists(csvFile)) {
+                            bitstamp_download_candle_history_csv_all(progress, symbol, fromYear, toYear, "minute");
+                        }
+                        bitstamp_parse_candle_history_csv(progress, csvFile, datFile, symbol);
+                    } else if (file_exists(csvFile)) {
+                        // refreshed csv (e.g. the current year), only the new rows are ingested
+                        bitstamp_parse_candle_history_csv(progress, csvFile, datFile, symbol);
                     }
-                    bitstamp_parse_candle_history_csv(progress, csvFile, datFile);
-                }
-                vector<Candle> yearCandles = bitstamp_read_candle_history_dat(datFile);
-                for (const Candle& candle: yearCandles) {
-                    if (startTime <= candle.getStart() && endTime >= candle.getEnd())
-                        candles.push_back(candle);
+                    string storeFile = datFile;
+                    if (period != MS_PER_MIN) {
+                        storeFile = str_replace(_aggFileTpl, "{year}", to_string(year));
+                        bitstamp_aggregate_candle_history_dat(progress, datFile, storeFile, symbol, period);
+                    }
+                    CandleStore* store = vector_create(stores, storeFile);
+                    starts.emplace_back();
+                    ends.emplace_back();
+                    store->getTimes(&starts.back(), &ends.back());
+                    size_t from, to;
+                    bitstamp_find_candle_range(starts.back(), ends.back(), startTime, endTime, from, to);
+                    ranges.push_back({ from, to });
+                    total += to - from;
+                    progress.update(year, fromYear, toYear, false);
                 }
-                progress.update(year, fromYear, toYear, false);
+
+                // one allocation, then each year's window straight from the columns
+                candles.clear();
+                invalidateCandleColumns();
+                candles.reserve(total);
+                for (size_t i = 0; i < stores.size(); i++)
+                    stores[i]->getCandles(candles, starts[i], ends[i], ranges[i].first, ranges[i].second);
+                // buckets straddling a year boundary are split between two files
+                if (period != MS_PER_MIN) candles_merge_adjacent(candles);
+            } catch (exception&) {
+                vector_destroy(stores);
+                throw;
             }
+            vector_destroy(stores);
             progress.close();
         }
 
         // Note: see more at https://www.cryptodatadownload.com/data/bitstamp/
         virtual void reload(Progress& progress) override {
-            if (period != MS_PER_MIN) throw ERROR("Period works only on minutes charts"); // TODO: aggregate to other periods
-            
             const bool override = zenity_question("Override", "Do you want to override if data already exists?");
         
             int fromYear = parse<int>(ms_to_date(startTime).substr(0, 4));
@@ -1,6 +1,7 @@
 #include "../../../../includes/madlib/trading/CandleStrategy.hpp"
 #include "../../../../includes/madlib/trading/Exchange.hpp"
 #include "../../../../includes/madlib/trading/inicators/EmaIndicator.hpp"
+#include "../../../../includes/madlib/trading/inicators/kernels.hpp"
 
 namespace madlib::trading::strategy {
 
@@ -17,6 +18,8 @@ namespace madlib::trading::strategy {
         ms_t waitBeforeBuyAgain = 120 * minute;
 
         //
+        pair_id_t pairId = 0; // resolved in onStart()
+        order_id_t takeProfitId = 0; // sells at sellAbove, placed at the buys
         ms_t dontBuyUntil = 0;
         double sellAbove = INFINITY;
         double buyPc = initialBuyPc;
@@ -29,6 +32,25 @@ namespace madlib::trading::strategy {
             buyBellow = price * buyBellowPc;
         }
 
+        // the full quoted balance goes above sellAbove where
+        // quoted + base * price = sellAbove, from there the exchange sells intrabar,
+        // false when the price is there already (e.g. profitPc < 1) so there is nothing to wait for
+        bool placeTakeProfit(Exchange*& exchange) {
+            if (takeProfitId) exchange->cancelOrder(takeProfitId);
+            takeProfitId = 0;
+            double balanceBase = exchange->getBalanceBase(pairId);
+            if (balanceBase <= 0) return true;
+            double price = (sellAbove - exchange->getBalanceQuoted(pairId)) / balanceBase;
+            if (price <= exchange->getPairAt(pairId).getPrice()) return false;
+            Exchange::OrderStatus status = exchange->executeTakeProfit(pairId, Exchange::SELL, balanceBase * sellPc, price, takeProfitId);
+            if (status != Exchange::ORDER_OPEN) LOGA(
+                " Exchange time: " + ms_to_datetime(exchange->getCurrentTime()) 
+                + ", Strategy take-profit Error, [" + exchange->getSymbol(pairId) + "] " + to_string(price)
+                + ": " + Exchange::getOrderStatusName(status)
+            );
+            return true;
+        }
+
     public:
 
         PointSeries* sellAboveProjector = nullptr;
@@ -39,7 +61,15 @@ namespace madlib::trading::strategy {
         EmaIndicator* emaIndicator2 = nullptr;
         EmaIndicator* emaIndicator3 = nullptr;
 
-        MartingaleCandleStrategy(): CandleStrategy() {}
+        // precalculated over the whole history, only projected on the history chart
+        vector<double> emas1, emas2, emas3;
+
+        // sell targets set at the buys, shown on the balance chart at the end of the run
+        vector<pair<ms_t, double>> sellAboves;
+
+        MartingaleCandleStrategy(): CandleStrategy() {
+            sellAboves.reserve(1024);
+        }
 
         virtual ~MartingaleCandleStrategy() {
             delete emaIndicator1;
@@ -49,63 +79,109 @@ namespace madlib::trading::strategy {
 
         bool first = true;
 
+        virtual void setParameter(const string& name, double value) override {
+            if (name == "initialBuyPc") initialBuyPc = value;
+            else if (name == "buyIncPc") buyIncPc = value;
+            else if (name == "profitPc") profitPc = value;
+            else if (name == "sellPc") sellPc = value;
+            else if (name == "buyBellowPc") buyBellowPc = value;
+            else if (name == "waitBeforeBuyAgain") waitBeforeBuyAgain = (ms_t)value;
+            else CandleStrategy::setParameter(name, value);
+        }
+
+        virtual void onCandleHistory(const CandleColumns& columns) override {
+            // nothing to project when running headless (e.g. sweeps)
+            if (!candleHistoryChart) {
+                emas1.clear();
+                emas2.clear();
+                emas3.clear();
+                return;
+            }
+            const vector<double>& closes = columns.getCloses();
+            const size_t size = closes.size();
+            emas1.resize(size);
+            emas2.resize(size);
+            emas3.resize(size);
+            if (!size) return;
+            indicator_ema(closes.data(), size, 2000, closes[0], emas1.data());
+            indicator_ema(closes.data(), size, 4000, closes[0], emas2.data());
+            indicator_ema(closes.data(), size, 16000, closes[0], emas3.data());
+        }
+
+        virtual void onStart(Exchange*& exchange, const string& symbol) override {
+            pairId = exchange->getPairId(symbol);
+            takeProfitId = 0;
+        }
+
         virtual void onFirstCandleClose(Exchange*&, const string&, const Candle& candle) override {            
             ms_t closeAt = candle.getEnd();
             double price = candle.getClose();
 
-            sellAboveProjector = balanceQuotedChart->createPointSeries(
+            // charts are not available when running headless
+            if (balanceQuotedChart) sellAboveProjector = balanceQuotedChart->createPointSeries(
                 balanceQuotedChart->getProjectorAt(0), darkGray
             );
 
-            emaIndicator1 = new EmaIndicator(candleHistoryChart, price, 2000, blue);
-            emaIndicator2 = new EmaIndicator(candleHistoryChart, price, 4000, green);
-            emaIndicator3 = new EmaIndicator(candleHistoryChart, price, 16000, orange);
+            if (candleHistoryChart) {
+                emaIndicator1 = new EmaIndicator(candleHistoryChart, price, 2000, blue);
+                emaIndicator2 = new EmaIndicator(candleHistoryChart, price, 4000, green);
+                emaIndicator3 = new EmaIndicator(candleHistoryChart, price, 16000, orange);
+            }
 
             // rsiChart = multichartAccordion->createChart("RSI", 200);
             // rsiProjector = rsiChart->createPointSeries();
 
+            sellAboves.clear();
             reinit(price, closeAt);
         }
 
-        virtual void onCandleClose(Exchange*& exchange, const string& symbol, const Candle& candle) override {            
+        virtual void onFinish(Exchange*&, const string&) override {
+            if (!sellAboveProjector) return;
+            sellAboveProjector->reservePoints(sellAboves.size());
+            for (const pair<ms_t, double>& sellAboveAt: sellAboves)
+                sellAboveProjector->addPoint(sellAboveAt.first, sellAboveAt.second);
+        }
+
+        virtual void onCandleClose(Exchange*& exchange, const string&, const Candle& candle) override {            
             ms_t closeAt = candle.getEnd();
             double price = candle.getClose();
-            double balanceQuotedFull = exchange->getBalanceQuotedFull(symbol);
-            double balanceQuoted = exchange->getBalanceQuoted(symbol);
-            double balanceBase = exchange->getBalanceBase(symbol);
+            double balanceQuotedFull = exchange->getBalanceQuotedFull(pairId);
+            double balanceQuoted = exchange->getBalanceQuoted(pairId);
 
-            emaIndicator1->calc(closeAt, price);
-            emaIndicator2->calc(closeAt, price);
-            emaIndicator3->calc(closeAt, price);
+            if (emaIndicator1) emaIndicator1->project(closeAt, emas1[candleIndex]);
+            if (emaIndicator2) emaIndicator2->project(closeAt, emas2[candleIndex]);
+            if (emaIndicator3) emaIndicator3->project(closeAt, emas3[candleIndex]);
 
             // rsiProjector->getShapes().push_back(
             //     rsiChart->createPointShape(closeAt, price)
             // );
 
 
-            // sell
-            if (balanceQuotedFull > sellAbove) {
-                double amount = balanceBase * sellPc;
-                marketSell(exchange, symbol, amount); // TODO couldn't sell?
+            // sold by the take-profit
+            if (takeProfitId && !exchange->isOrderOpen(takeProfitId)) {
+                recordFill(exchange, takeProfitId);
+                takeProfitId = 0;
                 reinit(price, closeAt);
                 return;
             }
 
-            // buy            
+            // buy (a rejected buy is logged and tried again at the next candle)
             if (dontBuyUntil <= closeAt && price < buyBellow) {
                 double amount = (balanceQuoted * buyPc) / price;
-                marketBuy(exchange, symbol, amount); // TODO: can't buy?
+                if (!marketBuy(exchange, pairId, amount)) return;
                 double _sellAbove = balanceQuotedFull * profitPc; 
                 sellAbove = 
                     // sellAbove > _sellAbove ? 
                     // sellAbove : 
                     _sellAbove;
-                sellAboveProjector->getShapes().push_back(
-                    balanceQuotedChart->createPointShape(closeAt, sellAbove)
-                );
+                sellAboves.push_back({ closeAt, sellAbove });
                 buyPc *= buyIncPc;
                 dontBuyUntil = closeAt + waitBeforeBuyAgain;
                 buyBellow = price * buyBellowPc;
+                if (!placeTakeProfit(exchange)) {
+                    marketSell(exchange, pairId, exchange->getBalanceBase(pairId) * sellPc);
+                    reinit(price, closeAt);
+                }
             }
         }
     };
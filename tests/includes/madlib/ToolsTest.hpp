@@ -7,6 +7,9 @@
 
 #include "../../../src/includes/madlib/sys.hpp"
 #include "../../../src/includes/madlib/maps.hpp"
+#include "../../../src/includes/madlib/csv.hpp"
+#include "../../../src/includes/madlib/datetime.hpp"
+#include "../../../src/includes/madlib/Log.hpp"
 
 using namespace std;
 using namespace clib;
@@ -347,4 +350,84 @@ public:
         assert(!map_key_exists(emptyMap, 1));
         assert(!map_key_exists(emptyMap, 2));
     }
+
+    static void test_csv_split_and_parse() {
+        const string csv = "1,2021-01-01 00:01:00, 12.5 ,+3\n\n2,x,,4";
+        const char* begin = csv.data();
+        const char* end = begin + csv.size();
+
+        CsvField fields[4];
+        const char* line = begin;
+        assert(csv_split_line(line, csv_line_end(line, end), fields, 4) == 4);
+        double value = 0;
+        assert(csv_parse(fields[0], value) && value == 1);
+        assert(fields[1].str() == "2021-01-01 00:01:00");
+        assert(csv_parse(fields[2], value) && value == 12.5);
+        assert(csv_parse(fields[3], value) && value == 3);
+        assert(!csv_parse(fields[1], value));
+
+        line = csv_next_line(line, end);
+        assert(csv_line_end(line, end) == line);
+        line = csv_next_line(line, end);
+        assert(csv_split_line(line, csv_line_end(line, end), fields, 4) == 4);
+        assert(fields[2].empty() && !csv_parse(fields[2], value));
+        assert(csv_next_line(line, end) == end);
+
+        // chunks cover the whole buffer and start at line beginnings
+        vector<CsvField> chunks = csv_split_chunks(begin, end, 3);
+        assert(!chunks.empty() && chunks.front().begin == begin && chunks.back().end == end);
+        for (size_t i = 1; i < chunks.size(); i++) {
+            assert(chunks[i].begin == chunks[i - 1].end);
+            assert(chunks[i].begin[-1] == '\n');
+        }
+    }
+
+    static void test_datetime_fixed_to_ms() {
+        ms_t ms = 0;
+        assert(datetime_fixed_to_ms("2023-01-15 08:30:45", ms) && ms == 1673771445000);
+        assert(datetime_fixed_to_ms("1969-12-31 23:59:59", ms) && ms == -1000);
+        assert(datetime_fixed_to_ms("2200-03-01 00:00:00", ms) && ms == datetime_to_ms("2200-03-01 00:00:00"));
+        assert(!datetime_fixed_to_ms("2023-13-15 08:30:45", ms));
+        assert(!datetime_fixed_to_ms("2023-01-15 08:3x:45", ms));
+        assert(!datetime_fixed_to_ms("2023/01/15 08:30:45", ms));
+        assert(!datetime_fixed_to_ms("2023-02-31 00:00:00", ms));
+        assert(!datetime_fixed_to_ms("2023-04-31 00:00:00", ms));
+        assert(!datetime_fixed_to_ms("2023-02-29 00:00:00", ms));
+        assert(!datetime_fixed_to_ms("2100-02-29 00:00:00", ms));
+        assert(datetime_fixed_to_ms("2000-02-29 00:00:00", ms) && ms == datetime_to_ms("2000-02-29 00:00:00"));
+        assert(datetime_fixed_to_ms("2023-12-31 00:00:00", ms));
+
+        // every day of a leap year at a few times of the day, the same as the general parser
+        for (ms_t t = datetime_to_ms("2024-01-01"); t < datetime_to_ms("2025-01-01"); t += 7 * MS_PER_HOUR + 13 * MS_PER_SEC) {
+            string datetime = ms_to_datetime(t, "%Y-%m-%d %H:%M:%S", false);
+            assert(datetime_fixed_to_ms(datetime.c_str(), ms) && ms == t && ms == datetime_to_ms(datetime));
+        }
+
+        string date = "2021-06-10";
+        assert(datetime_fast_to_ms(date.data(), date.data() + date.size()) == 1623283200000);
+        assert(unix_to_ms(1623283200) == 1623283200000);
+        assert(unix_to_ms(1623283200123.0) == 1623283200123);
+    }
+
+    static void test_datetime_fixed_to_ms_benchmark() {
+        const size_t count = 100000;
+        vector<string> datetimes;
+        datetimes.reserve(count);
+        for (size_t i = 0; i < count; i++)
+            datetimes.push_back(ms_to_datetime(datetime_to_ms("2020-01-01") + (ms_t)i * MS_PER_MIN, "%Y-%m-%d %H:%M:%S", false));
+
+        ms_t sum = 0;
+        ms_t start = now();
+        for (const string& datetime: datetimes) sum += datetime_to_ms(str_trim(datetime));
+        const ms_t general = now() - start;
+
+        ms_t fastSum = 0, ms = 0;
+        start = now();
+        for (const string& datetime: datetimes)
+            if (datetime_fixed_to_ms(datetime.c_str(), ms)) fastSum += ms;
+        const ms_t fixed = now() - start;
+
+        assert(sum == fastSum);
+        LOG("datetime parse of " + to_string(count) + " rows, general: " + to_string(general) + "ms, fixed: " + to_string(fixed) + "ms");
+    }
 };
@@ -4,6 +4,10 @@
 #include <string>
 #include <cassert>
 
+#include "../../../src/includes/madlib/MappedFile.hpp"
+#include "../../../src/includes/madlib/Arena.hpp"
+#include "../../../src/includes/madlib/RangeMinMax.hpp"
+
 using namespace std;
 using namespace madlib;
 
@@ -24,6 +28,7 @@ protected:
         remove("doubles.dat");
         remove("points.dat");
         remove("numbers_ref.dat");
+        remove("empty.dat");
     }
 
 public:
@@ -141,4 +146,85 @@ public:
 
         cleanup();
     }
+
+    static void testMappedFile_map() {
+        cleanup();
+
+        // Test case 1: Mapping saved custom objects (struct)
+        vector<Point> points = {{1, 2}, {3, 4}, {5, 6}};
+        vector_save("points.dat", points);
+        MappedFile<Point> mapped("points.dat");
+        assert(mapped.size() == points.size());
+        for (size_t i = 0; i < points.size(); i++) 
+            assert(comparePoints(points[i], mapped[i]));
+        
+        // Test case 2: Iterating over the mapped records
+        vector<Point> copied(mapped.begin(), mapped.end());
+        assert(vector_compare(points, copied, comparePoints));
+
+        // Test case 3: Mapping an empty file
+        vector_save("empty.dat", vector<Point>());
+        MappedFile<Point> empty("empty.dat");
+        assert(empty.empty());
+        assert(empty.begin() == empty.end());
+
+        // Test case 4: Mapping a missing file throws
+        try {
+            MappedFile<Point> missing("missing.dat");
+            assert(false);
+        } catch (const exception& e) {
+            assert(true);
+        }
+
+        cleanup();
+    }
+
+    static void testArena_CreateAndReset() {
+        Arena<Point, 4> points;
+        vector<Point*> created;
+        for (int i = 0; i < 10; i++) created.push_back(points.create(Point{ i, i * 2 }));
+        assert(points.size() == 10);
+        assert(points.capacity() == 12);
+        for (int i = 0; i < 10; i++) assert(created[i]->x == i && created[i]->y == i * 2);
+        assert(created[1] == created[0] + 1); // contiguous inside a chunk
+
+        // memory is reused after a reset
+        points.reset();
+        assert(points.size() == 0);
+        assert(points.create(Point{ 7, 8 }) == created[0]);
+        assert(points.capacity() == 12);
+
+        Arena<string, 2> strings;
+        for (int i = 0; i < 5; i++) strings.create(to_string(i) + string(100, 'x'));
+        strings.reset();
+        assert(*strings.create("reused") == "reused");
+    }
+
+    static void testRangeMinMax_MatchNaive() {
+        const size_t n = 1000;
+        vector<double> lows(n), highs(n);
+        unsigned int seed = 7;
+        for (size_t i = 0; i < n; i++) {
+            seed = seed * 1103515245 + 12345;
+            lows[i] = (double)(seed % 10007) - 5000;
+            highs[i] = lows[i] + (double)(seed % 13);
+        }
+        RangeMinMax<8> index;
+        index.build(n, [&](size_t i) { return lows[i]; }, [&](size_t i) { return highs[i]; });
+        assert(index.size() == n);
+
+        double min, max;
+        assert(!index.query(5, 5, min, max));
+        assert(!index.query(n, n + 10, min, max));
+        for (size_t from = 0; from < n; from += 37)
+            for (size_t to = from + 1; to <= n; to += 29) {
+                double naiveMin = lows[from], naiveMax = highs[from];
+                for (size_t i = from; i < to; i++) {
+                    if (naiveMin > lows[i]) naiveMin = lows[i];
+                    if (naiveMax < highs[i]) naiveMax = highs[i];
+                }
+                assert(index.query(from, to, min, max));
+                assert(min == naiveMin && max == naiveMax);
+            }
+    }
 };
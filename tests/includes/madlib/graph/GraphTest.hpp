@@ -0,0 +1,366 @@
+#pragma once
+
+#include <vector>
+#include <cassert>
+
+#include "../../../../src/includes/madlib/graph/Chart.hpp"
+
+using namespace std;
+using namespace madlib;
+using namespace madlib::graph;
+
+class GraphTest {
+public:
+
+    static void testCandlePyramid_Build() {
+        vector<CandleShape*> candles;
+        vector<Shape*> shapes;
+        for (int i = 0; i < 5; i++) {
+            double price = 10.0 + i;
+            candles.push_back(new CandleShape(i * 60, i * 60 + 59, price, price - i, price + 1.0, price + 0.5));
+            shapes.push_back(candles.back());
+        }
+
+        CandlePyramid pyramid;
+        pyramid.build(shapes);
+        assert(pyramid.getCount() == 5);
+        assert(pyramid.getLevels() == 3);
+        assert(pyramid.getLevel(1).size() == 3);
+        assert(pyramid.getLevel(2).size() == 2);
+        assert(pyramid.getLevel(3).size() == 1);
+
+        const CandlePyramid::Entry& pair = pyramid.getLevel(1)[0];
+        assert(pair.begin == 0 && pair.end == 119);
+        assert(pair.open == 10.0 && pair.close == 11.5);
+        assert(pair.low == 10.0 && pair.high == 12.0);
+
+        const CandlePyramid::Entry& all = pyramid.getLevel(3)[0];
+        assert(all.begin == 0 && all.end == 299);
+        assert(all.open == 10.0 && all.close == 14.5);
+        assert(all.low == 10.0 && all.high == 15.0);
+
+        // the odd candle is carried up to the next level as it is
+        assert(pyramid.getLevel(1)[2].open == 14.0);
+        assert(pyramid.getLevel(2)[1].low == 10.0);
+
+        assert(pyramid.selectLevel(1) == 0);
+        assert(pyramid.selectLevel(2) == 1);
+        assert(pyramid.selectLevel(7) == 2);
+        assert(pyramid.selectLevel(1000) == 3);
+
+        // a changed last candle is refreshed in every level
+        delete candles.back();
+        candles.back() = new CandleShape(240, 299, 14.0, 1.0, 30.0, 20.0);
+        shapes.back() = candles.back();
+        pyramid.update(shapes);
+        assert(pyramid.getCount() == 5);
+        assert(pyramid.getLevel(1)[2].close == 20.0);
+        assert(pyramid.getLevel(2)[1].high == 30.0);
+        assert(pyramid.getLevel(3)[0].low == 1.0);
+        assert(pyramid.getLevel(3)[0].close == 20.0);
+        assert(pyramid.getLevel(1)[0].close == 11.5);
+
+        // a new candle rebuilds it
+        candles.push_back(new CandleShape(300, 359, 20.0, 19.0, 21.0, 19.5));
+        shapes.push_back(candles.back());
+        pyramid.update(shapes);
+        assert(pyramid.getCount() == 6);
+        assert(pyramid.getLevel(1).size() == 3);
+        assert(pyramid.getLevel(1)[2].close == 19.5);
+        assert(pyramid.getLevel(3)[0].close == 19.5);
+
+        pyramid.clear();
+        assert(pyramid.getLevels() == 0);
+        vector_destroy(candles);
+    }
+
+    static void testArena_Shapes() {
+        Arena<PointShape, 4> points;
+        Arena<CandleShape, 4> candles;
+        Arena<LabelShape, 4> labels;
+        vector<PointShape*> created;
+        for (int i = 0; i < 6; i++) {
+            created.push_back(points.create(i * 10, i * 1.5));
+            candles.create(i * 60, i * 60 + 59, 10.0, 9.0, 12.0, 11.0 + i);
+            labels.create(i * 10, i * 1.5, "label " + to_string(i) + string(40, '.'), black);
+        }
+        assert(points.size() == 6 && candles.size() == 6 && labels.size() == 6);
+        assert(created[3]->time() == 30 && created[3]->value() == 4.5);
+        assert(created[1] == created[0] + 1);
+
+        // the chunks are reused, the labels release their texts
+        points.reset();
+        candles.reset();
+        labels.reset();
+        assert(points.size() == 0 && candles.size() == 0 && labels.size() == 0);
+        assert(points.create(1, 2.0) == created[0]);
+        assert(candles.create(0, 59, 1.0, 0.5, 2.0, 1.5)->close() == 1.5);
+        assert(labels.create(0, 1.0, "reused", black)->text() == "reused");
+        assert(points.capacity() == 8);
+    }
+
+    static void testPointSeries_TimeSeries() {
+        vector<ms_t> times;
+        TimeSeries timeSeries;
+        timeSeries.setTimes(&times);
+        PointSeries columnSeries(nullptr);
+        PointSeries shapeSeries(nullptr);
+        columnSeries.setTimeSeries(&timeSeries);
+        vector<PointShape*> points;
+        for (int i = 0; i < 20; i++) {
+            double value = (i * 7) % 11;
+            times.push_back(i * 10);
+            timeSeries.push_back(value);
+            points.push_back(new PointShape(i * 10, value));
+            shapeSeries.getShapes().push_back(points.back());
+        }
+        PointSeries ownSeries(nullptr);
+        for (int i = 0; i < 20; i++) ownSeries.addPoint(i * 10, timeSeries.value(i));
+        assert(ownSeries.getTimeSeries()->size() == 20);
+        assert(timeSeries.size() == 20);
+        timeSeries.push_back(1); // no time for it yet
+        assert(timeSeries.size() == 20);
+
+        const ms_t ranges[][2] = { { 0, 190 }, { 35, 120 }, { 40, 40 }, { -50, 5 }, { 300, 400 }, { 185, 400 } };
+        for (const auto& range: ranges) {
+            columnSeries.getCanvas().chartBegin = shapeSeries.getCanvas().chartBegin = range[0];
+            columnSeries.getCanvas().chartEnd = shapeSeries.getCanvas().chartEnd = range[1];
+            bool found = columnSeries.searchShapeIndexFromToAndValueMinMax();
+            assert(found == shapeSeries.searchShapeIndexFromToAndValueMinMax());
+            if (!found) continue;
+            const Projector::Canvas& expected = shapeSeries.getCanvas();
+            const Projector::Canvas& actual = columnSeries.getCanvas();
+            assert(actual.shapeIndexFrom == expected.shapeIndexFrom);
+            assert(actual.shapeIndexTo == expected.shapeIndexTo);
+            assert(actual.shapesValueMin == expected.shapesValueMin);
+            assert(actual.shapesValueMax == expected.shapesValueMax);
+            ownSeries.getCanvas().chartBegin = range[0];
+            ownSeries.getCanvas().chartEnd = range[1];
+            assert(ownSeries.searchShapeIndexFromToAndValueMinMax());
+            assert(ownSeries.getCanvas().shapeIndexFrom == expected.shapeIndexFrom);
+            assert(ownSeries.getCanvas().shapeIndexTo == expected.shapeIndexTo);
+        }
+
+        for (PointShape* point: points) delete point;
+    }
+
+    static void testCandleSeries_ValueTyped() {
+        CandleSeries typedSeries(nullptr);
+        CandleSeries shapeSeries(nullptr);
+        vector<CandleShape*> shapes;
+        for (int i = 0; i < 30; i++) {
+            double price = 100 + (i * 13) % 17;
+            typedSeries.addCandle(i * 60, i * 60 + 59, price, price - 2, price + 3, price + 1);
+            shapes.push_back(new CandleShape(i * 60, i * 60 + 59, price, price - 2, price + 3, price + 1));
+            shapeSeries.getShapes().push_back(shapes.back());
+        }
+        assert(typedSeries.getCandles().size() == 30);
+        assert(typedSeries.getShapes().empty());
+
+        const ms_t ranges[][2] = { { 0, 1800 }, { 70, 900 }, { 61, 61 }, { -100, 10 }, { 5000, 6000 }, { 1700, 5000 } };
+        for (const auto& range: ranges) {
+            typedSeries.getCanvas().chartBegin = shapeSeries.getCanvas().chartBegin = range[0];
+            typedSeries.getCanvas().chartEnd = shapeSeries.getCanvas().chartEnd = range[1];
+            bool found = typedSeries.searchShapeIndexFromToAndValueMinMax();
+            assert(found == shapeSeries.searchShapeIndexFromToAndValueMinMax());
+            if (!found) continue;
+            const Projector::Canvas& expected = shapeSeries.getCanvas();
+            const Projector::Canvas& actual = typedSeries.getCanvas();
+            assert(actual.shapeIndexFrom == expected.shapeIndexFrom);
+            assert(actual.shapeIndexTo == expected.shapeIndexTo);
+            assert(actual.shapesValueMin == expected.shapesValueMin);
+            assert(actual.shapesValueMax == expected.shapesValueMax);
+        }
+
+        CandlePyramid fromShapes, fromValues;
+        fromShapes.build(shapeSeries.getShapes());
+        fromValues.build(typedSeries.getCandles());
+        assert(fromShapes.getLevels() == fromValues.getLevels());
+        for (size_t level = 1; level <= fromShapes.getLevels(); level++)
+            for (size_t i = 0; i < fromShapes.getLevel(level).size(); i++) {
+                assert(fromShapes.getLevel(level)[i].low == fromValues.getLevel(level)[i].low);
+                assert(fromShapes.getLevel(level)[i].high == fromValues.getLevel(level)[i].high);
+            }
+
+        typedSeries.clearShapes();
+        assert(typedSeries.getCandles().empty());
+        assert(!typedSeries.searchShapeIndexFromToAndValueMinMax());
+
+        for (CandleShape* shape: shapes) delete shape;
+    }
+
+    static void testCandleSeries_PyramidEdit() {
+        struct PyramidSeries: CandleSeries {
+            PyramidSeries(): CandleSeries(nullptr) {}
+            const CandlePyramid& refresh() {
+                updatePyramid(shapes);
+                return pyramid;
+            }
+        } series;
+        vector<CandleShape> candles;
+        for (int i = 0; i < 8; i++) candles.push_back(CandleShape(i * 60, i * 60 + 59, 10, 5, 15, 12));
+        for (CandleShape& candle: candles) series.addShape(&candle);
+        assert(series.refresh().getLevel(3)[0].high == 15);
+
+        // a candle in the middle edited through the mutable shapes
+        CandleShape spike(120, 179, 10, 1, 90, 12);
+        series.getShapes()[2] = &spike;
+        const CandlePyramid& pyramid = series.refresh();
+        assert(pyramid.getLevel(1)[1].high == 90 && pyramid.getLevel(1)[1].low == 1);
+        assert(pyramid.getLevel(3)[0].high == 90 && pyramid.getLevel(3)[0].low == 1);
+    }
+
+    static void testSeries_IncrementalValueIndex() {
+        PointSeries pointSeries(nullptr);
+        CandleSeries candleSeries(nullptr);
+        Projector::Canvas& points = pointSeries.getCanvas();
+        Projector::Canvas& candles = candleSeries.getCanvas();
+        points.chartBegin = candles.chartBegin = 0;
+        points.chartEnd = candles.chartEnd = 1000000;
+        for (int i = 0; i < 100; i++) {
+            pointSeries.addPoint(i, 10 + i % 5);
+            candleSeries.addCandle(i * 2, i * 2 + 1, 10, 5, 15, 12);
+        }
+        assert(pointSeries.searchShapeIndexFromToAndValueMinMax());
+        assert(points.shapesValueMin == 10 && points.shapesValueMax == 14);
+        assert(candleSeries.searchShapeIndexFromToAndValueMinMax());
+        assert(candles.shapesValueMin == 5 && candles.shapesValueMax == 15);
+
+        // appended after the index was built
+        for (int i = 100; i < 200; i++) {
+            pointSeries.addPoint(i, i == 150 ? 99 : 10);
+            candleSeries.addCandle(i * 2, i * 2 + 1, 10, i == 150 ? 1 : 5, 15, 12);
+        }
+        assert(pointSeries.searchShapeIndexFromToAndValueMinMax());
+        assert(points.shapesValueMin == 10 && points.shapesValueMax == 99);
+        assert(candleSeries.searchShapeIndexFromToAndValueMinMax());
+        assert(candles.shapesValueMin == 1 && candles.shapesValueMax == 15);
+
+        // a visible window without the extremes
+        points.chartBegin = 160;
+        candles.chartBegin = 320;
+        assert(pointSeries.searchShapeIndexFromToAndValueMinMax());
+        assert(points.shapesValueMin == 10 && points.shapesValueMax == 10);
+        assert(candleSeries.searchShapeIndexFromToAndValueMinMax());
+        assert(candles.shapesValueMin == 5 && candles.shapesValueMax == 15);
+
+        pointSeries.clearShapes();
+        assert(!pointSeries.searchShapeIndexFromToAndValueMinMax());
+        pointSeries.addPoint(200, 3);
+        pointSeries.addPoint(201, 4);
+        assert(pointSeries.searchShapeIndexFromToAndValueMinMax());
+        assert(points.shapesValueMin == 3 && points.shapesValueMax == 3);
+
+        // shapes replaced in place (same count) are seen by the next search
+        PointSeries shapeSeries(nullptr);
+        Projector::Canvas& shapeCanvas = shapeSeries.getCanvas();
+        shapeCanvas.chartBegin = 0;
+        shapeCanvas.chartEnd = 1000000;
+        vector<PointShape> shapes = { PointShape(0, 1), PointShape(1, 2), PointShape(2, 3), PointShape(3, 4) };
+        PointShape replacement(1, 50);
+        for (PointShape& shape: shapes) shapeSeries.addShape(&shape);
+        assert(shapeSeries.searchShapeIndexFromToAndValueMinMax());
+        assert(shapeCanvas.shapesValueMax == 3);
+        shapeSeries.getShapes()[1] = &replacement;
+        assert(shapeSeries.searchShapeIndexFromToAndValueMinMax());
+        assert(shapeCanvas.shapesValueMin == 1 && shapeCanvas.shapesValueMax == 50);
+    }
+
+    static void testSeries_ContentVersion() {
+        // same count, changed content
+        PointSeries shapeSeries(nullptr);
+        PointShape first(0, 1), second(1, 2), replacement(1, 50);
+        shapeSeries.addShape(&first);
+        shapeSeries.addShape(&second);
+        size_t version = shapeSeries.getVersion();
+        shapeSeries.getShapes()[1] = &replacement;
+        assert(shapeSeries.getVersion() > version);
+        version = shapeSeries.getVersion();
+        assert(shapeSeries.getVersion() == version);
+
+        // an external time series refilled by its owner
+        TimeSeries timeSeries;
+        PointSeries columnSeries(nullptr);
+        for (int i = 0; i < 3; i++) timeSeries.push_back(i, i);
+        columnSeries.setTimeSeries(&timeSeries);
+        version = columnSeries.getVersion();
+        assert(columnSeries.getVersion() == version);
+        timeSeries.clear();
+        for (int i = 0; i < 3; i++) timeSeries.push_back(i, i * 2);
+        assert(columnSeries.size() == 3 && columnSeries.getVersion() > version);
+
+        CandleSeries candleSeries(nullptr);
+        version = candleSeries.getVersion();
+        candleSeries.addCandle(0, 59, 10, 5, 15, 12);
+        assert(candleSeries.getVersion() > version);
+        version = candleSeries.getVersion();
+        candleSeries.clearShapes();
+        assert(candleSeries.getVersion() > version);
+    }
+
+    static void testViewport_ClipLine() {
+        Viewport viewport(0, 0, 100, 50);
+        int x1, y1, x2, y2;
+
+        // inside, untouched
+        x1 = 10; y1 = 10; x2 = 90; y2 = 40;
+        assert(viewport.clipLine(x1, y1, x2, y2));
+        assert(x1 == 10 && y1 == 10 && x2 == 90 && y2 == 40);
+
+        // crossing the whole viewport horizontally
+        x1 = -50; y1 = 25; x2 = 150; y2 = 25;
+        assert(viewport.clipLine(x1, y1, x2, y2));
+        assert(x1 == 0 && y1 == 25 && x2 == 100 && y2 == 25);
+
+        // leaving through the bottom edge
+        x1 = 0; y1 = 0; x2 = 200; y2 = 100;
+        assert(viewport.clipLine(x1, y1, x2, y2));
+        assert(x1 == 0 && y1 == 0 && x2 == 100 && y2 == 50);
+
+        // entering from the left, going up
+        x1 = -10; y1 = 40; x2 = 10; y2 = 20;
+        assert(viewport.clipLine(x1, y1, x2, y2));
+        assert(x1 == 0 && y1 == 30 && x2 == 10 && y2 == 20);
+
+        // outside, also when the bounding box overlaps
+        x1 = 110; y1 = 0; x2 = 150; y2 = 40;
+        assert(!viewport.clipLine(x1, y1, x2, y2));
+        x1 = 90; y1 = -20; x2 = 120; y2 = 10;
+        assert(!viewport.clipLine(x1, y1, x2, y2));
+    }
+
+    static void testGlyphMetrics_Clip() {
+        // 'a'..'z' are 'a' - 96 pixels wide, everything else falls back to the default '?'
+        vector<XCharStruct> perChar(256 - 32);
+        for (unsigned int c = 'a'; c <= 'z'; c++) perChar[c - 32].width = (short)(c - 96);
+        perChar['?' - 32].width = 7;
+        XFontStruct fontInfo = {};
+        fontInfo.min_char_or_byte2 = 32;
+        fontInfo.max_char_or_byte2 = 255;
+        fontInfo.default_char = '?';
+        fontInfo.per_char = perChar.data();
+        fontInfo.ascent = 10;
+        fontInfo.descent = 3;
+
+        GlyphMetrics metrics(fontInfo);
+        assert(metrics.getHeight() == 13);
+        assert(metrics.width("abc") == 6);
+        assert(metrics.width("a\x01") == 8);
+        assert(metrics.width("") == 0);
+
+        size_t begin, end;
+        int offset;
+        // "abcd" is 1 + 2 + 3 + 4 pixels
+        assert(metrics.clip("abcd", 0, 10, begin, end, offset));
+        assert(begin == 0 && end == 4 && offset == 0);
+        assert(metrics.clip("abcd", 1, 10, begin, end, offset));
+        assert(begin == 1 && end == 4 && offset == 1);
+        assert(metrics.clip("abcd", 2, 6, begin, end, offset));
+        assert(begin == 2 && end == 3 && offset == 3);
+        assert(metrics.clip("abcd", -5, 5, begin, end, offset));
+        assert(begin == 0 && end == 2 && offset == 0);
+        assert(!metrics.clip("abcd", 7, 9, begin, end, offset));
+        assert(!metrics.clip("abcd", 11, 20, begin, end, offset));
+        assert(!metrics.clip("", 0, 10, begin, end, offset));
+    }
+};
\ No newline at end of file
@@ -3,6 +3,12 @@
 #include <cassert>
 
 #include "../../../../src/includes/madlib/trading/Balance.hpp"
+#include "../../../../src/includes/madlib/trading/CandleStore.hpp"
+#include "../../../../src/includes/madlib/trading/CandleAggregator.hpp"
+#include "../../../../src/includes/madlib/trading/inicators/kernels.hpp"
+#include "../../../../src/includes/madlib/rand.hpp"
+#include "../../../../src/includes/madlib/Factory.hpp"
+#include "../../../../src/includes/madlib/trading/CandleStrategySweep.hpp"
 
 using namespace madlib::trading;
 
@@ -447,4 +453,792 @@ public:
             assert(str_ends_with("Unimplemented", e.what()));
         }
     }
+
+    static void testCandleHistory_CandleColumns() {
+        TestableCandleHistory candleHistory("AAPL", 0, 0, 0);
+        assert(candleHistory.getCandleColumns().empty());
+        candleHistory.addCandle(Candle(10.0, 20.0, 5.0, 25.0, 1000.0, 0, 59));
+        candleHistory.addCandle(Candle(20.0, 15.0, 14.0, 21.0, 1500.0, 60, 119));
+
+        const CandleColumns& columns = candleHistory.getCandleColumns();
+        assert(columns.size() == 2);
+        assert(columns.getOpens()[1] == 20.0);
+        assert(columns.getCloses()[0] == 20.0);
+        assert(columns.getLows()[1] == 14.0);
+        assert(columns.getHighs()[0] == 25.0);
+        assert(columns.getVolumes()[1] == 1500.0);
+        assert(columns.getStarts()[1] == 60);
+        assert(columns.getEnds()[0] == 59);
+        assert(columns.at(1).getClose() == 15.0);
+
+        // follows the candles
+        candleHistory.addCandle(Candle(15.0, 16.0, 15.0, 17.0, 0.0, 120, 179));
+        assert(candleHistory.getCandleColumns().size() == 3);
+        assert(candleHistory.getCandleColumns().getCloses()[2] == 16.0);
+
+        // concurrent first use builds the columns once for every reader
+        candleHistory.addCandle(Candle(16.0, 18.0, 16.0, 19.0, 10.0, 180, 239));
+        vector<const CandleColumns*> seen(4, nullptr);
+        vector<thread> readers;
+        for (size_t i = 0; i < seen.size(); i++)
+            readers.emplace_back([&candleHistory, &seen, i]() {
+                seen[i] = &candleHistory.getCandleColumns();
+            });
+        for (thread& reader: readers) reader.join();
+        for (const CandleColumns* columns: seen) {
+            assert(columns == seen[0]);
+            assert(columns->size() == 4);
+            assert(columns->getCloses()[3] == 18.0);
+        }
+    }
+
+    // CandleStore
+
+    static void testCandleStore_SaveAndLoad() {
+        vector<Candle> candles = {
+            Candle(10.0, 20.0, 5.0, 25.0, 1000.0, 60000, 119999),
+            Candle(20.0, 15.0, 14.0, 21.0, 1500.0, 120000, 179999),
+            Candle(15.0, 16.0, 15.0, 17.0, 0.0, 240000, 299999),
+        };
+        CandleStore::save("candles.dat", "BTCUSD", MS_PER_MIN, candles);
+
+        CandleStore store("candles.dat");
+        assert(store.getSymbol() == "BTCUSD");
+        assert(store.getPeriod() == MS_PER_MIN);
+        assert(store.size() == 3);
+        assert(store.getFirstStart() == 60000);
+        assert(store.getLastStart() == 240000);
+        assert(store.getCloses()[1] == 15.0);
+
+        vector<ms_t> starts, ends;
+        store.getTimes(&starts, &ends);
+        assert(starts[2] == 240000);
+        assert(ends[1] == 179999);
+
+        vector<Candle> loaded = CandleStore::load("candles.dat");
+        assert(loaded.size() == candles.size());
+        for (size_t i = 0; i < candles.size(); i++) {
+            assert(loaded[i].getOpen() == candles[i].getOpen());
+            assert(loaded[i].getClose() == candles[i].getClose());
+            assert(loaded[i].getLow() == candles[i].getLow());
+            assert(loaded[i].getHigh() == candles[i].getHigh());
+            assert(loaded[i].getVolume() == candles[i].getVolume());
+            assert(loaded[i].getStart() == candles[i].getStart());
+            assert(loaded[i].getEnd() == candles[i].getEnd());
+        }
+
+        vector<Candle> window;
+        store.getCandles(window, 1, 2);
+        assert(window.size() == 1);
+        assert(window[0].getStart() == 120000);
+
+        remove("candles.dat");
+    }
+
+    static void testCandleStore_Append() {
+        vector<Candle> candles = {
+            Candle(10.0, 20.0, 5.0, 25.0, 1000.0, 60000, 119999),
+            Candle(20.0, 15.0, 14.0, 21.0, 1500.0, 120000, 179999),
+        };
+        vector<Candle> newer = {
+            Candle(15.0, 16.0, 15.0, 17.0, 0.0, 180000, 239999),
+            Candle(16.0, 18.0, 16.0, 19.0, 10.0, 240000, 299999),
+        };
+        CandleStore::save("candles.dat", "BTCUSD", MS_PER_MIN, candles);
+        CandleStore store("candles.dat");
+        store.append(newer);
+        assert(store.size() == 4);
+        assert(store.getFirstStart() == 60000);
+        assert(store.getLastStart() == 240000);
+
+        // extended checksums have to match a freshly saved store
+        candles.insert(candles.end(), newer.begin(), newer.end());
+        CandleStore::save("candles2.dat", "BTCUSD", MS_PER_MIN, candles);
+        assert(file_get_contents("candles.dat") == file_get_contents("candles2.dat"));
+        vector<Candle> loaded = CandleStore::load("candles.dat");
+        assert(loaded.size() == 4);
+        assert(loaded[2].getStart() == 180000);
+        assert(loaded[3].getEnd() == 299999);
+        assert(loaded[3].getClose() == 18.0);
+        assert(!file_exists("candles.dat.tmp"));
+
+        try {
+            store.append({ Candle(1.0, 1.0, 1.0, 1.0, 1.0, 240000, 299999) });
+            assert(false);
+        } catch (const exception& e) {
+            assert(string(e.what()).find("not newer") != string::npos);
+        }
+
+        remove("candles.dat");
+        remove("candles2.dat");
+    }
+
+    static void testCandleStore_InvalidFile() {
+        vector<Candle> candles = { Candle(1.0, 1.0, 1.0, 1.0, 1.0, 0, 1) };
+        vector_save("candles.dat", candles); // raw POD dump, not a store
+        assert(!CandleStore::isValid("candles.dat"));
+        try {
+            CandleStore store("candles.dat");
+            assert(false);
+        } catch (const exception& e) {
+            assert(string(e.what()).find("Not a candle store") != string::npos);
+        }
+
+        // corrupted column is detected when the column is used
+        CandleStore::save("candles.dat", "BTCUSD", MS_PER_MIN, candles);
+        string data = file_get_contents("candles.dat");
+        data[sizeof(CandleStore::Header)] ^= 0x55;
+        file_put_contents("candles.dat", data);
+        assert(!CandleStore::isValid("candles.dat"));
+        CandleStore store("candles.dat");
+        try {
+            store.getOpens();
+            assert(false);
+        } catch (const exception& e) {
+            assert(string(e.what()).find("checksum mismatch") != string::npos);
+        }
+
+        // headers pointing outside the file or at the wrong number of rows
+        CandleStore::save("candles.dat", "BTCUSD", MS_PER_MIN, candles);
+        const string saved = file_get_contents("candles.dat");
+        for (int broken = 0; broken < 4; broken++) {
+            CandleStore::Header h;
+            memcpy(&h, saved.data(), sizeof(h));
+            switch (broken) {
+                case 0: h.count = 2; break;
+                case 1: h.columnOffsets[CandleStore::CLOSE] = UINT64_MAX - 4; break;
+                case 2: h.columnBytes[CandleStore::HIGH] = UINT64_MAX; break;
+                default: h.columnOffsets[CandleStore::LOW] += 1; break;
+            }
+            file_put_contents("candles.dat", string((const char*)&h, sizeof(h)) + saved.substr(sizeof(h)));
+            assert(!CandleStore::isValid("candles.dat"));
+        }
+
+        remove("candles.dat");
+    }
+
+    static void testCandleStore_ReadVersion1() {
+        vector<Candle> candles = {
+            Candle(10.0, 20.0, 5.0, 25.0, 1000.0, 60000, 119999),
+            Candle(20.0, 15.0, 14.0, 21.0, 1500.0, 120000, 179999),
+        };
+        CandleStore::save("candles.dat", "BTCUSD", MS_PER_MIN, candles);
+
+        // rewrite it with the shorter version 1 header
+        string data = file_get_contents("candles.dat");
+        CandleStore::Header h;
+        memcpy(&h, data.data(), sizeof(h));
+        const size_t v1Size = CandleStore::headerSize(1);
+        h.version = 1;
+        for (int col = 0; col < CandleStore::COLUMNS; col++)
+            h.columnOffsets[col] -= sizeof(h) - v1Size;
+        file_put_contents("candles.dat", string((const char*)&h, v1Size) + data.substr(sizeof(h)));
+
+        CandleStore store("candles.dat");
+        assert(store.getHeader().version == 1);
+        assert(store.size() == 2);
+        assert(store.getSourceCount() == 0);
+        assert(store.getCloses()[1] == 15.0);
+
+        // appending upgrades the file
+        store.append({ Candle(15.0, 16.0, 15.0, 17.0, 0.0, 180000, 239999) });
+        assert(store.getHeader().version == CandleStore::version);
+        vector<Candle> loaded = CandleStore::load("candles.dat");
+        assert(loaded.size() == 3);
+        assert(loaded[1].getEnd() == 179999);
+
+        remove("candles.dat");
+    }
+
+    static void testCandleAggregator_Aggregate() {
+        vector<Candle> minutes;
+        for (int i = 0; i < 150; i++) {
+            double price = 100.0 + i;
+            minutes.push_back(Candle(price, price + 0.5, price - 1.0, price + 2.0, 1.0, i * MS_PER_MIN, (i + 1) * MS_PER_MIN - 1));
+        }
+
+        vector<Candle> hours;
+        candles_aggregate(minutes, MS_PER_HOUR, hours);
+        assert(hours.size() == 3);
+        assert(hours[0].getOpen() == 100.0);
+        assert(hours[0].getClose() == 159.5);
+        assert(hours[0].getLow() == 99.0);
+        assert(hours[0].getHigh() == 161.0);
+        assert(hours[0].getVolume() == 60.0);
+        assert(hours[1].getStart() == MS_PER_HOUR);
+        assert(hours[1].getEnd() == 2 * MS_PER_HOUR - 1);
+        assert(hours[2].getVolume() == 30.0); // partial last bucket
+
+        // the same from the store columns
+        CandleStore::save("candles.dat", "BTCUSD", MS_PER_MIN, minutes);
+        CandleStore store("candles.dat");
+        vector<Candle> stored;
+        candles_aggregate(store, MS_PER_HOUR, stored);
+        assert(stored.size() == hours.size());
+        assert(stored[2].getClose() == hours[2].getClose());
+        CandleStore::save("hours.dat", "BTCUSD", MS_PER_HOUR, stored, &store);
+        CandleStore aggregated("hours.dat");
+        assert(aggregated.getSourceCount() == 150);
+        assert(aggregated.getSourceLastStart() == 149 * MS_PER_MIN);
+        remove("hours.dat");
+        try {
+            candles_aggregate(store, MS_PER_SEC, stored);
+            assert(false);
+        } catch (const exception& e) {
+            assert(string(e.what()).find("Can not aggregate") != string::npos);
+        }
+        remove("candles.dat");
+
+        // bucket split in two parts (e.g. at a year boundary)
+        vector<Candle> first(minutes.begin(), minutes.begin() + 90), second(minutes.begin() + 90, minutes.end());
+        vector<Candle> split;
+        candles_aggregate(first, MS_PER_HOUR, split);
+        candles_aggregate(second, MS_PER_HOUR, split);
+        assert(split.size() == 4);
+        candles_merge_adjacent(split);
+        assert(split.size() == 3);
+        assert(split[1].getOpen() == hours[1].getOpen());
+        assert(split[1].getClose() == hours[1].getClose());
+        assert(split[1].getVolume() == 60.0);
+
+        // weeks start on Monday (1970-01-05), not on the Thursday of the epoch
+        assert(CandleAggregator::bucketStart(0, MS_PER_WEEK) == -3 * MS_PER_DAY);
+        assert(CandleAggregator::bucketStart(4 * MS_PER_DAY, MS_PER_WEEK) == 4 * MS_PER_DAY);
+        assert(CandleAggregator::bucketStart(11 * MS_PER_DAY - 1, MS_PER_WEEK) == 4 * MS_PER_DAY);
+        assert(CandleAggregator::bucketStart(25 * MS_PER_HOUR, MS_PER_DAY) == MS_PER_DAY);
+    }
+
+    // Indicator kernels
+
+    static bool near(double a, double b, double eps = 1e-9) {
+        return (isnan(a) && isnan(b)) || fabs(a - b) <= eps * (1 + fabs(b));
+    }
+
+    static void testIndicatorKernels_MatchNaive() {
+        const size_t n = 37; // not a multiple of any vector width
+        vector<double> opens(n), closes(n), lows(n), highs(n), volumes(n);
+        for (size_t i = 0; i < n; i++) {
+            opens[i] = 100 + 10 * sin((double)i * 0.7);
+            closes[i] = 100 + 10 * sin((double)(i + 1) * 0.7);
+            lows[i] = min(opens[i], closes[i]) - (double)(i % 3);
+            highs[i] = max(opens[i], closes[i]) + (double)(i % 4);
+            volumes[i] = (double)(i % 5);
+        }
+        const size_t period = 5;
+        vector<double> out(n), out2(n), out3(n);
+
+        indicator_ema(closes.data(), n, 20, closes[0], out.data());
+        double ema = closes[0];
+        for (size_t i = 0; i < n; i++) {
+            if (i) ema = (ema * 20 + closes[i]) / 21; // EmaIndicator::calc
+            assert(near(out[i], ema));
+        }
+
+        indicator_sma(closes.data(), n, period, out.data());
+        indicator_rolling_min(lows.data(), n, period, out2.data());
+        indicator_rolling_max(highs.data(), n, period, out3.data());
+        for (size_t i = 0; i < n; i++) {
+            if (i + 1 < period) {
+                assert(isnan(out[i]) && isnan(out2[i]) && isnan(out3[i]));
+                continue;
+            }
+            double sum = 0, lo = INFINITY, hi = -INFINITY;
+            for (size_t j = i + 1 - period; j <= i; j++) {
+                sum += closes[j];
+                lo = min(lo, lows[j]);
+                hi = max(hi, highs[j]);
+            }
+            assert(near(out[i], sum / period));
+            assert(out2[i] == lo);
+            assert(out3[i] == hi);
+        }
+
+        vector<double> middle(n), upper(n), lower(n);
+        indicator_bollinger(closes.data(), n, period, 2, middle.data(), upper.data(), lower.data());
+        for (size_t i = period - 1; i < n; i++) {
+            double mean = 0, var = 0;
+            for (size_t j = i + 1 - period; j <= i; j++) mean += closes[j] / period;
+            for (size_t j = i + 1 - period; j <= i; j++) var += (closes[j] - mean) * (closes[j] - mean) / period;
+            assert(near(middle[i], mean));
+            assert(near(upper[i], mean + 2 * sqrt(var), 1e-7));
+            assert(near(lower[i], mean - 2 * sqrt(var), 1e-7));
+        }
+
+        indicator_atr(highs.data(), lows.data(), closes.data(), n, period, out.data());
+        double atr = 0;
+        for (size_t i = 0; i < n; i++) {
+            double range = highs[i] - lows[i];
+            if (i) range = max(range, max(fabs(highs[i] - closes[i - 1]), fabs(lows[i] - closes[i - 1])));
+            if (i < period) atr += range / period;
+            else atr = (atr * (period - 1) + range) / period;
+            assert(i + 1 < period ? isnan(out[i]) : near(out[i], atr));
+        }
+
+        indicator_rsi(closes.data(), n, period, out.data());
+        double gain = 0, loss = 0;
+        for (size_t i = 1; i < n; i++) {
+            double diff = closes[i] - closes[i - 1];
+            double g = diff > 0 ? diff : 0, l = diff < 0 ? -diff : 0;
+            if (i <= period) { gain += g / period; loss += l / period; }
+            else { gain = (gain * (period - 1) + g) / period; loss = (loss * (period - 1) + l) / period; }
+            if (i < period) assert(isnan(out[i]));
+            else assert(near(out[i], loss == 0 ? 100 : 100 - 100 / (1 + gain / loss), 1e-7));
+        }
+
+        indicator_vwap(highs.data(), lows.data(), closes.data(), volumes.data(), n, out.data());
+        double pv = 0, v = 0;
+        for (size_t i = 0; i < n; i++) {
+            pv += (highs[i] + lows[i] + closes[i]) / 3 * volumes[i];
+            v += volumes[i];
+            assert(near(out[i], v > 0 ? pv / v : (highs[i] + lows[i] + closes[i]) / 3));
+        }
+    }
+
+    // CandleStrategySweep
+
+    class SweepTestStrategy: public CandleStrategy {
+    protected:
+        double amount = 0;
+        bool bought = false;
+    public:
+        using CandleStrategy::CandleStrategy;
+        virtual ~SweepTestStrategy() {}
+        virtual void setParameter(const string& name, double value) override {
+            if (name == "amount") amount = value;
+            else CandleStrategy::setParameter(name, value);
+        }
+        virtual void onStart(Exchange*&, const string&) override {
+            bought = false;
+        }
+        virtual void onFirstCandleClose(Exchange*&, const string&, const Candle&) override {}
+        virtual void onCandleClose(Exchange*& exchange, const string& symbol, const Candle&) override {
+            if (bought) return;
+            marketBuy(exchange, symbol, amount);
+            bought = true;
+        }
+    };
+
+    static CandleStrategy* createSweepTestStrategy() {
+        return new SweepTestStrategy();
+    }
+
+    static void testCandleStrategySweep_Grid() {
+        static const Fees fees(0, 0, 0, 0);
+        TestableCandleHistory candleHistory("BTCUSD", 0, 0, MS_PER_MIN);
+        const double prices[] = { 100, 100, 80, 120, 150, 140 };
+        for (size_t i = 0; i < 6; i++)
+            candleHistory.addCandle(Candle(prices[i], prices[i], prices[i], prices[i], 1, (ms_t)i * MS_PER_MIN, (ms_t)(i + 1) * MS_PER_MIN - 1));
+        TestExchange testExchange(
+            { "1m" }, { "BTCUSD" },
+            { { "BTCUSD", Pair("BTC", "USD", fees, 100) } },
+            { { "BTC", Balance(0) }, { "USD", Balance(1000) } }
+        );
+
+        CandleStrategySweep sweep(&candleHistory, testExchange, createSweepTestStrategy, "BTCUSD");
+        sweep.addGrid("amount", 0, 10, 1);
+        vector<vector<double>> points = sweep.getGridPoints();
+        assert(points.size() == 11);
+
+        vector<CandleStrategySweep::Result> results = sweep.run(points, 4);
+        vector<CandleStrategySweep::Result> sequential = sweep.run(points, 1);
+        assert(results.size() == 11);
+        for (size_t i = 0; i < results.size(); i++) {
+            const CandleStrategySweep::Result& result = results[i];
+            const double amount = (double)i;
+            assert(result.error.empty());
+            assert(result.parameters[0] == amount);
+            // bought at 100 (second candle), valued at 140 at the end
+            assert(result.balanceQuotedFullStart == 1000);
+            assert(near(result.balanceQuotedFull, 1000 + amount * 40));
+            assert(near(result.profitPc, amount * 4));
+            // peak at 150, down to 80 from the 100 it was bought at
+            assert(near(result.maxDrawdownPc, max(amount * 20 / 1000 * 100, (amount * 10) / (1000 + amount * 50) * 100)));
+            assert(result.balanceQuotedFull == sequential[i].balanceQuotedFull);
+        }
+        // the exchange given is only a prototype
+        assert(testExchange.getBalanceQuoted("BTCUSD") == 1000);
+
+        // unknown parameters are reported per run
+        CandleStrategySweep invalid(&candleHistory, testExchange, createSweepTestStrategy, "BTCUSD");
+        invalid.addValues("unknown", { 1 });
+        vector<CandleStrategySweep::Result> errors = invalid.run(invalid.getGridPoints());
+        assert(errors.size() == 1);
+        assert(errors[0].error.find("Unknown strategy parameter") != string::npos);
+
+        CandleStrategySweep random(&candleHistory, testExchange, createSweepTestStrategy, "BTCUSD");
+        random.addRange("amount", 1, 2);
+        vector<vector<double>> randomPoints = random.getRandomPoints(20, 42);
+        assert(randomPoints == random.getRandomPoints(20, 42));
+        for (const vector<double>& point: randomPoints) assert(point[0] >= 1 && point[0] <= 2);
+
+        // the global generator is not reseeded
+        rand_init_seed(7);
+        random.getRandomPoints(5, 42);
+        const double next = randd(0, 1);
+        rand_init_seed(7);
+        assert(randd(0, 1) == next);
+        rand_close();
+    }
+
+    // TradeJournal
+
+    static void testTradeJournal_Backtest() {
+        static const Fees fees(0.01, 0.01, 0, 0);
+        const string symbol = "BTCUSD"; // the backtester keeps a reference
+        TestableCandleHistory candleHistory("BTCUSD", 0, 0, MS_PER_MIN);
+        const double prices[] = { 100, 100, 80 };
+        for (size_t i = 0; i < 3; i++)
+            candleHistory.addCandle(Candle(prices[i], prices[i], prices[i], prices[i], 1, (ms_t)i * MS_PER_MIN, (ms_t)(i + 1) * MS_PER_MIN - 1));
+        TestExchange testExchange(
+            { "1m" }, { "BTCUSD" },
+            { { "BTCUSD", Pair("BTC", "USD", fees, 100) } },
+            { { "BTC", Balance(0) }, { "USD", Balance(1000) } }
+        );
+        TestExchange* exchangePtr = &testExchange;
+        CandleHistory* candleHistoryPtr = &candleHistory;
+
+        SweepTestStrategy strategy;
+        CandleStrategy* strategyPtr = &strategy;
+        strategy.setParameter("amount", 2);
+        CandleStrategyBacktester backtester(nullptr, candleHistoryPtr, exchangePtr, strategyPtr, symbol);
+        assert(backtester.backtest());
+
+        const TradeJournal& journal = strategy.getTradeJournal();
+        assert(journal.size() == 1);
+        const TradeJournal::Event& event = journal.at(0);
+        assert(event.time == 2 * MS_PER_MIN - 1);
+        assert(event.price == 100);
+        assert(event.amount == 2);
+        assert(near(event.fee, 2 * 0.01 * 100));
+        assert(event.side == TradeJournal::BUY && event.status == TradeJournal::FILLED);
+        assert(journal.count(TradeJournal::BUY) == 1);
+        assert(near(journal.getFeesTotal(), 2));
+
+        // a failed order is recorded too, the journal restarts with every backtest
+        SweepTestStrategy broke;
+        CandleStrategy* brokePtr = &broke;
+        broke.setParameter("amount", 1000);
+        CandleStrategyBacktester brokeBacktester(nullptr, candleHistoryPtr, exchangePtr, brokePtr, symbol);
+        assert(brokeBacktester.backtest());
+        assert(brokeBacktester.backtest());
+        assert(broke.getTradeJournal().size() == 1);
+        assert(broke.getTradeJournal().at(0).status == TradeJournal::FAILED);
+        assert(broke.getTradeJournal().getFeesTotal() == 0);
+    }
+
+    // MartingaleCandleStrategy
+
+    static void testMartingaleCandleStrategy_ProfitBelowOne() {
+        static const Fees fees(0, 0, 0, 0);
+        const string symbol = "BTCUSD"; // the backtester keeps a reference
+        TestableCandleHistory candleHistory("BTCUSD", 0, 0, MS_PER_MIN);
+        const double prices[] = { 100, 100, 80, 80 };
+        for (size_t i = 0; i < 4; i++)
+            candleHistory.addCandle(Candle(prices[i], prices[i], prices[i], prices[i], 1, (ms_t)i * MS_PER_MIN, (ms_t)(i + 1) * MS_PER_MIN - 1));
+        TestExchange testExchange(
+            { "1m" }, { "BTCUSD" },
+            { { "BTCUSD", Pair("BTC", "USD", fees, 100) } },
+            { { "BTC", Balance(0) }, { "USD", Balance(1000) } }
+        );
+        TestExchange* exchangePtr = &testExchange;
+        CandleHistory* candleHistoryPtr = &candleHistory;
+
+        Factory<CandleStrategy> factory;
+        CandleStrategy* strategy = factory.createInstance(
+            "build/release/src/shared/trading/strategy/MartingaleCandleStrategy/"
+            "MartingaleCandleStrategy.so"
+        );
+        strategy->setParameter("profitPc", 0.5);
+        strategy->setParameter("sellPc", 1);
+        strategy->setParameter("waitBeforeBuyAgain", 0);
+        CandleStrategyBacktester backtester(nullptr, candleHistoryPtr, exchangePtr, strategy, symbol);
+        assert(backtester.backtest());
+
+        // the sell target is below the price at the buy, sold at once instead of never
+        const TradeJournal& journal = strategy->getTradeJournal();
+        assert(journal.count(TradeJournal::BUY) == 1);
+        assert(journal.count(TradeJournal::SELL) == 1);
+        assert(journal.at(1).side == TradeJournal::SELL && journal.at(1).status == TradeJournal::FILLED);
+        assert(journal.at(1).price == 80);
+        assert(testExchange.getOpenOrderCount() == 0);
+        assert(near(testExchange.getBalanceBase(symbol), 0));
+        assert(near(testExchange.getBalanceQuoted(symbol), 1000));
+    }
+
+    // Exchange
+
+    static void testExchange_InternedIds() {
+        static const Fees fees(0.01, 0.01, 0, 0);
+        TestExchange testExchange(
+            { "1m" }, { "BTCUSD", "ETHUSD" },
+            { 
+                { "BTCUSD", Pair("BTC", "USD", fees, 100) },
+                { "ETHUSD", Pair("ETH", "USD", fees, 10) } 
+            },
+            { { "BTC", Balance(1) }, { "ETH", Balance(2) }, { "USD", Balance(1000) } }
+        );
+
+        const pair_id_t btc = testExchange.getPairId("BTCUSD");
+        const pair_id_t eth = testExchange.getPairId("ETHUSD");
+        assert(btc != eth);
+        assert(testExchange.getPairId("BTCUSD") == btc);
+        assert(testExchange.getSymbol(eth) == "ETHUSD");
+        assert(&testExchange.getPairAt(btc) == &testExchange.getPairAt("BTCUSD"));
+        // the quoted currency is shared
+        assert(&testExchange.getQuotedBalanceAt(btc) == &testExchange.getQuotedBalanceAt(eth));
+        assert(testExchange.getBalanceQuotedFull(btc) == 1100);
+        assert(testExchange.getBalanceQuotedFull(btc) == testExchange.getBalanceQuotedFull("BTCUSD"));
+        assert(testExchange.getBalanceBaseFull(eth) == testExchange.getBalanceBaseFull(testExchange.getPairAt("ETHUSD")));
+
+        bool thrown = false;
+        try { testExchange.getPairId("XXXUSD"); } catch (exception&) { thrown = true; }
+        assert(thrown);
+
+        // a copy resolves the same ids to its own pairs and balances
+        TestExchange copy(testExchange);
+        assert(copy.marketBuy(btc, 2));
+        assert(near(copy.getBalanceBase(btc), 1 + 2 - 0.02));
+        assert(copy.getBalanceQuoted(eth) == 800);
+        assert(copy.getBalanceBase("BTCUSD") == copy.getBalanceBase(btc));
+        assert(testExchange.getBalanceBase(btc) == 1);
+        assert(testExchange.getBalanceQuoted(btc) == 1000);
+        copy.getPairAt(btc).setPrice(200);
+        assert(testExchange.getPairAt(btc).getPrice() == 100);
+    }
+
+    static void testExchange_ExecuteOrderStatus() {
+        static const Fees fees(0.01, 0.01, 0, 0);
+        TestExchange testExchange(
+            { "1m" }, { "BTCUSD" },
+            { { "BTCUSD", Pair("BTC", "USD", fees, 100) } },
+            { { "BTC", Balance(1) }, { "USD", Balance(1000) } }
+        );
+        const pair_id_t btc = testExchange.getPairId("BTCUSD");
+
+        // rejected orders leave both balances untouched
+        assert(testExchange.executeMarketBuy(btc, 11) == Exchange::ORDER_INSUFFICIENT_FUNDS);
+        assert(testExchange.executeMarketSell(btc, 2) == Exchange::ORDER_INSUFFICIENT_FUNDS);
+        assert(testExchange.executeMarketBuy(btc, -1) == Exchange::ORDER_INVALID_AMOUNT);
+        assert(testExchange.executeMarketSell(btc, NAN) == Exchange::ORDER_INVALID_AMOUNT);
+        assert(testExchange.executeMarketBuy(btc, 0) == Exchange::ORDER_INVALID_AMOUNT);
+        assert(testExchange.executeMarketSell(btc, 0) == Exchange::ORDER_INVALID_AMOUNT);
+        assert(testExchange.getBalanceBase(btc) == 1 && testExchange.getBalanceQuoted(btc) == 1000);
+
+        assert(testExchange.executeMarketBuy(btc, 10) == Exchange::ORDER_FILLED);
+        assert(testExchange.getBalanceQuoted(btc) == 0);
+        assert(near(testExchange.getBalanceBase(btc), 1 + 10 - 0.1));
+        assert(testExchange.executeMarketSell(btc, 1) == Exchange::ORDER_FILLED);
+        assert(near(testExchange.getBalanceQuoted(btc), 100 - 1));
+
+        testExchange.getPairAt(btc).setPrice(0);
+        assert(testExchange.executeMarketBuy(btc, 1) == Exchange::ORDER_INVALID_PRICE);
+        testExchange.getPairAt(btc).setPrice(100);
+
+        // the bool API throws only when asked to
+        assert(!testExchange.marketBuy(btc, 1000, false));
+        bool thrown = false;
+        try { testExchange.marketBuy("BTCUSD", 1000); } catch (exception&) { thrown = true; }
+        assert(thrown);
+        assert(near(testExchange.getBalanceQuoted(btc), 100 - 1));
+    }
+
+    static void testTestExchange_LimitOrders() {
+        static const Fees fees(0, 0, 0.01, 0.02);
+        TestExchange testExchange(
+            { "1m" }, { "BTCUSD" },
+            { { "BTCUSD", Pair("BTC", "USD", fees, 100) } },
+            { { "BTC", Balance(1) }, { "USD", Balance(1000) } }
+        );
+        const pair_id_t btc = testExchange.getPairId("BTCUSD");
+        const currency_id_t usd = testExchange.getQuotedCurrencyId(btc);
+        const currency_id_t bitcoin = testExchange.getBaseCurrencyId(btc);
+
+        order_id_t buy90, buy95, buy95b, buy80, sell110, rejected;
+        assert(testExchange.executeLimitBuy(btc, 2, 90, buy90) == Exchange::ORDER_OPEN);
+        assert(testExchange.executeLimitBuy(btc, 2, 95, buy95) == Exchange::ORDER_OPEN);
+        assert(testExchange.executeLimitBuy(btc, 1, 95, buy95b) == Exchange::ORDER_OPEN);
+        assert(testExchange.executeLimitBuy(btc, 4, 80, buy80) == Exchange::ORDER_OPEN);
+        assert(testExchange.executeLimitSell(btc, 1, 110, sell110) == Exchange::ORDER_OPEN);
+        assert(testExchange.getOpenOrderCount() == 5);
+        assert(testExchange.getLockedAmount(usd) == 180 + 190 + 95 + 320);
+        assert(testExchange.getLockedAmount(bitcoin) == 1);
+
+        // the locked funds stay in the balance but can not be spent twice
+        assert(testExchange.getBalanceQuoted(btc) == 1000);
+        assert(testExchange.executeLimitBuy(btc, 3, 100, rejected) == Exchange::ORDER_INSUFFICIENT_FUNDS && !rejected);
+        assert(testExchange.executeMarketSell(btc, 1) == Exchange::ORDER_INSUFFICIENT_FUNDS);
+        assert(testExchange.executeLimitBuy(btc, 0, 100, rejected) == Exchange::ORDER_INVALID_AMOUNT);
+        assert(testExchange.executeLimitBuy(btc, 1, -1, rejected) == Exchange::ORDER_INVALID_PRICE);
+
+        // only the orders inside the candle's range fill, the same prices in order
+        assert(testExchange.matchOrders(btc, 92, 105) == 2);
+        const vector<TestExchange::Fill>& fills = testExchange.getFills();
+        assert(fills.size() == 2);
+        assert(fills[0].orderId == buy95 && fills[1].orderId == buy95b);
+        assert(fills[0].price == 95 && fills[0].side == Exchange::BUY);
+        assert(near(fills[0].fee, 2 * 0.01));
+        assert(!testExchange.isOrderOpen(buy95) && testExchange.isOrderOpen(buy90));
+        assert(near(testExchange.getBalanceQuoted(btc), 1000 - 285));
+        assert(near(testExchange.getBalanceBase(btc), 1 + 3 - 0.03));
+        assert(near(testExchange.getLockedAmount(usd), 180 + 320));
+
+        assert(testExchange.cancelOrder(buy80));
+        assert(!testExchange.cancelOrder(buy80));
+        assert(near(testExchange.getLockedAmount(usd), 180));
+
+        assert(testExchange.matchOrders(btc, 85, 112) == 2);
+        assert(fills.size() == 4);
+        assert(fills[2].orderId == buy90 && fills[3].orderId == sell110);
+        assert(near(fills[3].fee, 110 * 0.02));
+        assert(near(testExchange.getBalanceQuoted(btc), 1000 - 285 - 180 + 110 - 2.2));
+        assert(near(testExchange.getBalanceBase(btc), 1 + 3 - 0.03 + 2 - 0.02 - 1));
+        assert(testExchange.getOpenOrderCount() == 0);
+        assert(near(testExchange.getLockedAmount(usd), 0) && near(testExchange.getLockedAmount(bitcoin), 0));
+        assert(testExchange.matchOrders(btc, 0, 1000) == 0);
+
+        // a gap beyond the limit fills at the candle's edge, the lock is released in full
+        order_id_t buy100, sell105;
+        const double quoted = testExchange.getBalanceQuoted(btc);
+        assert(testExchange.executeLimitBuy(btc, 1, 100, buy100) == Exchange::ORDER_OPEN);
+        assert(testExchange.matchOrders(btc, 70, 85) == 1);
+        assert(fills.back().orderId == buy100 && fills.back().price == 85);
+        assert(near(testExchange.getBalanceQuoted(btc), quoted - 85));
+        assert(near(testExchange.getLockedAmount(usd), 0));
+        assert(testExchange.executeLimitSell(btc, 1, 105, sell105) == Exchange::ORDER_OPEN);
+        assert(testExchange.matchOrders(btc, 120, 130) == 1);
+        assert(fills.back().orderId == sell105 && fills.back().price == 120);
+
+        // a fill the balances can no longer take changes neither of them
+        order_id_t buy50;
+        assert(testExchange.executeLimitBuy(btc, 1, 50, buy50) == Exchange::ORDER_OPEN);
+        testExchange.getBalanceAt(usd).setAmount(20);
+        const double base = testExchange.getBalanceBase(btc);
+        const size_t filled = fills.size();
+        assert(testExchange.matchOrders(btc, 40, 60) == 0);
+        assert(fills.size() == filled && testExchange.getRejects().back() == buy50);
+        assert(testExchange.getBalanceBase(btc) == base && testExchange.getBalanceQuoted(btc) == 20);
+        assert(!testExchange.isOrderOpen(buy50) && near(testExchange.getLockedAmount(usd), 0));
+    }
+
+    static void testTestExchange_TriggerOrders() {
+        static const Fees fees(0.01, 0.01, 0.001, 0.002);
+        TestExchange testExchange(
+            { "1m" }, { "BTCUSD" },
+            { { "BTCUSD", Pair("BTC", "USD", fees, 100) } },
+            { { "BTC", Balance(4) }, { "USD", Balance(1000) } }
+        );
+        const pair_id_t btc = testExchange.getPairId("BTCUSD");
+        const currency_id_t bitcoin = testExchange.getBaseCurrencyId(btc);
+        const currency_id_t usd = testExchange.getQuotedCurrencyId(btc);
+        const vector<TestExchange::Fill>& fills = testExchange.getFills();
+
+        // a sell stop is reached by a falling price, a sell take-profit by a rising one
+        order_id_t stop, takeProfit, buyStop;
+        assert(testExchange.executeStopLoss(btc, Exchange::SELL, 1, 90, stop) == Exchange::ORDER_OPEN);
+        assert(testExchange.executeTakeProfit(btc, Exchange::SELL, 1, 120, takeProfit) == Exchange::ORDER_OPEN);
+        assert(testExchange.executeStopLoss(btc, Exchange::BUY, 1, 110, buyStop) == Exchange::ORDER_OPEN);
+        assert(testExchange.getLockedAmount(bitcoin) == 2 && testExchange.getLockedAmount(usd) == 110);
+        assert(testExchange.matchOrders(btc, 95, 105) == 0);
+
+        // filled at the trigger price, not at the close
+        assert(testExchange.matchOrders(btc, 85, 112) == 2);
+        assert(fills[0].orderId == stop && fills[0].price == 90 && fills[0].type == Exchange::STOP_LOSS);
+        assert(near(fills[0].fee, 90 * 0.01));
+        assert(fills[1].orderId == buyStop && fills[1].price == 110 && fills[1].side == Exchange::BUY);
+        assert(testExchange.isOrderOpen(takeProfit));
+        assert(testExchange.matchOrders(btc, 100, 125) == 1);
+        assert(fills[2].orderId == takeProfit && near(fills[2].fee, 120 * 0.002));
+        assert(near(testExchange.getBalanceBase(btc), 4 - 1 + 1 - 0.01 - 1));
+        assert(near(testExchange.getBalanceQuoted(btc), 1000 + 90 - 0.9 - 110 + 120 - 0.24));
+        assert(near(testExchange.getLockedAmount(bitcoin), 0) && near(testExchange.getLockedAmount(usd), 0));
+
+        // OCO: the legs share one lock, the first one reached cancels the other one
+        order_id_t ocoTakeProfit, ocoStop;
+        assert(testExchange.executeOco(btc, Exchange::SELL, 2, 130, 80, ocoTakeProfit, ocoStop) == Exchange::ORDER_OPEN);
+        assert(testExchange.getOpenOrderCount() == 2);
+        assert(near(testExchange.getLockedAmount(bitcoin), 2));
+        assert(testExchange.matchOrders(btc, 90, 135) == 1);
+        assert(fills.back().orderId == ocoTakeProfit);
+        assert(!testExchange.isOrderOpen(ocoStop));
+        assert(testExchange.getOpenOrderCount() == 0);
+        assert(near(testExchange.getLockedAmount(bitcoin), 0));
+        assert(testExchange.matchOrders(btc, 10, 20) == 0);
+
+        // a candle reaching both legs fills the stop
+        assert(testExchange.executeOco(btc, Exchange::SELL, 0.25, 130, 80, ocoTakeProfit, ocoStop) == Exchange::ORDER_OPEN);
+        assert(testExchange.matchOrders(btc, 70, 140) == 1);
+        assert(fills.back().orderId == ocoStop);
+
+        // cancelling one leg cancels both
+        assert(testExchange.executeOco(btc, Exchange::SELL, 0.25, 130, 80, ocoTakeProfit, ocoStop) == Exchange::ORDER_OPEN);
+        assert(testExchange.cancelOrder(ocoStop));
+        assert(!testExchange.isOrderOpen(ocoTakeProfit));
+        assert(near(testExchange.getLockedAmount(bitcoin), 0));
+
+        order_id_t rejected, rejectedStop;
+        assert(testExchange.executeOco(btc, Exchange::SELL, 100, 130, 80, rejected, rejectedStop) == Exchange::ORDER_INSUFFICIENT_FUNDS);
+        assert(!rejected && !rejectedStop && testExchange.getOpenOrderCount() == 0);
+        assert(testExchange.executeOco(btc, Exchange::SELL, 0.25, 0, 80, rejected, rejectedStop) == Exchange::ORDER_INVALID_PRICE);
+        assert(!rejected && !rejectedStop && testExchange.getOpenOrderCount() == 0);
+
+        Exchange::Fill fill;
+        assert(testExchange.findFill(takeProfit, fill) && fill.price == 120);
+        assert(!testExchange.findFill(ocoTakeProfit, fill));
+
+        // a buy OCO reached on both legs fills the stop too (its take-profit is the falling leg)
+        assert(testExchange.executeOco(btc, Exchange::BUY, 1, 80, 120, ocoTakeProfit, ocoStop) == Exchange::ORDER_OPEN);
+        assert(near(testExchange.getLockedAmount(usd), 120));
+        assert(testExchange.matchOrders(btc, 70, 130) == 1);
+        assert(fills.back().orderId == ocoStop && fills.back().price == 120 && fills.back().side == Exchange::BUY);
+        assert(!testExchange.isOrderOpen(ocoTakeProfit) && testExchange.getOpenOrderCount() == 0);
+        assert(near(testExchange.getLockedAmount(usd), 0));
+    }
+
+    static void testTestExchange_TriggerOrdersGap() {
+        static const Fees fees(0, 0, 0, 0);
+        TestExchange testExchange(
+            { "1m" }, { "BTCUSD" },
+            { { "BTCUSD", Pair("BTC", "USD", fees, 100) } },
+            { { "BTC", Balance(4) }, { "USD", Balance(1000) } }
+        );
+        const pair_id_t btc = testExchange.getPairId("BTCUSD");
+        const vector<TestExchange::Fill>& fills = testExchange.getFills();
+
+        // the candle gapped past the stops, they fill at the nearest traded price
+        order_id_t sellStop, buyStop;
+        assert(testExchange.executeStopLoss(btc, Exchange::SELL, 1, 90, sellStop) == Exchange::ORDER_OPEN);
+        assert(testExchange.matchOrders(btc, 70, 85) == 1);
+        assert(fills.back().orderId == sellStop && fills.back().price == 85);
+        assert(near(testExchange.getBalanceQuoted(btc), 1000 + 85));
+        assert(testExchange.executeStopLoss(btc, Exchange::BUY, 1, 110, buyStop) == Exchange::ORDER_OPEN);
+        assert(testExchange.matchOrders(btc, 115, 125) == 1);
+        assert(fills.back().orderId == buyStop && fills.back().price == 115);
+        assert(near(testExchange.getBalanceQuoted(btc), 1000 + 85 - 115));
+
+        // reached inside the range, at the stop price
+        assert(testExchange.executeStopLoss(btc, Exchange::SELL, 1, 90, sellStop) == Exchange::ORDER_OPEN);
+        assert(testExchange.matchOrders(btc, 80, 95) == 1);
+        assert(fills.back().price == 90);
+
+        // a gapped buy stop costs more than it locked, it buys only what the
+        // free funds cover and leaves the lock of the other orders alone
+        TestExchange broke(
+            { "1m" }, { "BTCUSD" },
+            { { "BTCUSD", Pair("BTC", "USD", fees, 100) } },
+            { { "BTC", Balance(0) }, { "USD", Balance(110 + 50) } }
+        );
+        const pair_id_t pair = broke.getPairId("BTCUSD");
+        const currency_id_t usd = broke.getQuotedCurrencyId(pair);
+        order_id_t buy50;
+        assert(broke.executeLimitBuy(pair, 1, 50, buy50) == Exchange::ORDER_OPEN);
+        assert(broke.executeStopLoss(pair, Exchange::BUY, 1, 110, buyStop) == Exchange::ORDER_OPEN);
+        assert(broke.matchOrders(pair, 115, 125) == 1);
+        const Exchange::Fill& fill = broke.getFills().back();
+        assert(fill.orderId == buyStop && fill.price == 115 && near(fill.amount, 110.0 / 115));
+        assert(near(broke.getBalanceBase(pair), 110.0 / 115) && broke.getBalanceBase(pair) < 1);
+        assert(near(broke.getBalanceQuoted(pair), 50) && near(broke.getLockedAmount(usd), 50));
+        assert(broke.isOrderOpen(buy50) && broke.getRejects().empty());
+        assert(broke.matchOrders(pair, 40, 60) == 1);
+        assert(near(broke.getBalanceQuoted(pair), 0) && near(broke.getBalanceBase(pair), 110.0 / 115 + 1));
+    }
 };
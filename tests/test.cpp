@@ -7,6 +7,7 @@
 #include "includes/madlib/VectorTest.hpp"
 #include "includes/madlib/FilesTest.hpp"
 #include "includes/madlib/LogTest.hpp"
+#include "includes/madlib/graph/GraphTest.hpp"
 
 // Manual tests
 #include "includes/madlib/graph/graph_manual_test1.hpp"
@@ -95,10 +96,15 @@ void unit_tests() {
     TEST(ToolsTest::test_map_has);
     TEST(ToolsTest::test_map_keys);
     TEST(ToolsTest::test_map_key_exists);
+    TEST(ToolsTest::test_csv_split_and_parse);
+    TEST(ToolsTest::test_datetime_fixed_to_ms);
     TEST(VectorTest::test_vector_create_destroy);
     TEST(VectorTest::testVector_concat);
     TEST(VectorTest::testVector_save_and_load);
     TEST(VectorTest::testVector_load_and_load_with_reference);
+    TEST(VectorTest::testMappedFile_map);
+    TEST(VectorTest::testArena_CreateAndReset);
+    TEST(VectorTest::testRangeMinMax_MatchNaive);
     TEST(FilesTest::testFiles_findByExtension);
     TEST(FilesTest::testFiles_findByExtensions);
     TEST(FilesTest::testFiles_replaceExtension);
@@ -111,6 +117,15 @@ void unit_tests() {
     TEST(FilesTest::testFiles_file_get_contents);
     TEST(FilesTest::testFiles_file_put_contents);
     TEST(LogTest::testLog_writeln);
+    TEST(GraphTest::testCandlePyramid_Build);
+    TEST(GraphTest::testArena_Shapes);
+    TEST(GraphTest::testPointSeries_TimeSeries);
+    TEST(GraphTest::testCandleSeries_ValueTyped);
+    TEST(GraphTest::testCandleSeries_PyramidEdit);
+    TEST(GraphTest::testSeries_IncrementalValueIndex);
+    TEST(GraphTest::testSeries_ContentVersion);
+    TEST(GraphTest::testViewport_ClipLine);
+    TEST(GraphTest::testGlyphMetrics_Clip);
 }
 
 void unit_tests_trading() {
@@ -141,9 +156,25 @@ void unit_tests_trading() {
     TEST(TradingTest::testHistory_SetAndGetPeriod);
     TEST(TradingTest::testHistory_Load);
     TEST(TradingTest::testHistory_Reload);
+    TEST(TradingTest::testCandleHistory_CandleColumns);
+    TEST(TradingTest::testCandleStore_SaveAndLoad);
+    TEST(TradingTest::testCandleStore_Append);
+    TEST(TradingTest::testCandleStore_InvalidFile);
+    TEST(TradingTest::testCandleStore_ReadVersion1);
+    TEST(TradingTest::testCandleAggregator_Aggregate);
+    TEST(TradingTest::testIndicatorKernels_MatchNaive);
+    TEST(TradingTest::testCandleStrategySweep_Grid);
+    TEST(TradingTest::testTradeJournal_Backtest);
+    TEST(TradingTest::testMartingaleCandleStrategy_ProfitBelowOne);
+    TEST(TradingTest::testExchange_InternedIds);
+    TEST(TradingTest::testExchange_ExecuteOrderStatus);
+    TEST(TradingTest::testTestExchange_LimitOrders);
+    TEST(TradingTest::testTestExchange_TriggerOrders);
+    TEST(TradingTest::testTestExchange_TriggerOrdersGap);
 }
 
 void manual_tests() {
+    TEST(ToolsTest::test_datetime_fixed_to_ms_benchmark);
     TEST(new TestCandleHistoryChartReload);
     TEST(new ChartLabelManualTest1);
     TEST(new ChartManualTest7Zoom);